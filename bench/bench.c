@@ -0,0 +1,486 @@
+// Copyright (C) 2025  gstaaij
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Microbenchmarks for the public generation functions.
+// Every result is printed as one JSON object per line, so runs of different commits can be diffed or loaded
+// into a spreadsheet. Build and run it with `./nob bench`.
+
+#define _POSIX_C_SOURCE 199309L
+#include <renoise.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <inttypes.h>
+
+#define RUNS 5
+// Every run repeats the benchmarked function until it covered at least this many samples
+#define MIN_SAMPLES_PER_RUN (1 << 18)
+// Skip worlds with more samples than this, they take too long to generate over and over
+#define MAX_WORLD_SAMPLES (1 << 20)
+#define SEED 0x5EED
+
+static const int64_t world_sizes[] = { 4, 8, 16, 32 };
+static const int64_t chunk_sizes[] = { 8, 16, 32, 64 };
+static const double frequencies[] = { 0.2, 0.5 };
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef struct {
+    const char* name;
+    int64_t world_size;
+    // RENOISE_CHUNK_SIZE when 0
+    int64_t chunk_size;
+    double frequency;
+    // Chunks whose points (or, for chunk_generate, gradient points) one call computes
+    int64_t chunks_per_call;
+    // chunk_size^2 when 0, RENOISE_CHUNK_SIZE^3 for 3D chunks
+    int64_t samples_per_chunk;
+    int64_t calls_per_run;
+    double run_ns[RUNS];
+} Bench_Result;
+
+static void report(Bench_Result* result) {
+    if (result->chunk_size == 0) result->chunk_size = RENOISE_CHUNK_SIZE;
+    if (result->samples_per_chunk == 0) result->samples_per_chunk = result->chunk_size*result->chunk_size;
+    int64_t samples_per_run = result->chunks_per_call * result->calls_per_run * result->samples_per_chunk;
+    double mean = 0.0;
+    for (int run = 0; run < RUNS; ++run) mean += result->run_ns[run] / samples_per_run;
+    mean /= RUNS;
+    double variance = 0.0;
+    for (int run = 0; run < RUNS; ++run) {
+        double deviation = result->run_ns[run] / samples_per_run - mean;
+        variance += deviation * deviation;
+    }
+    variance /= RUNS - 1;
+
+    printf(
+        "{\"bench\": \"%s\", \"version\": \"%s\", \"chunk_size\": %"PRIi64", \"world_size\": %"PRIi64", \"frequency\": %g, "
+        "\"runs\": %d, \"samples_per_run\": %"PRIi64", \"ns_per_sample\": %.4f, \"ns_per_sample_variance\": %.6f, "
+        "\"chunks_per_second\": %.1f}\n",
+        result->name, RENOISE_VERSION, result->chunk_size, result->world_size, result->frequency,
+        RUNS, samples_per_run, mean, variance,
+        1e9 / (mean * result->samples_per_chunk)
+    );
+    fflush(stdout);
+}
+
+static int64_t calls_for(int64_t chunks_per_call, int64_t samples_per_chunk) {
+    int64_t samples_per_call = chunks_per_call * samples_per_chunk;
+    int64_t calls = MIN_SAMPLES_PER_RUN / samples_per_call;
+    return calls < 1 ? 1 : calls;
+}
+
+static void bench_chunk_generate(double frequency) {
+    Bench_Result result = {
+        .name = "chunk_generate",
+        .world_size = 1,
+        .frequency = frequency,
+        .chunks_per_call = 1,
+        .calls_per_run = calls_for(1, RENOISE_CHUNK_SIZE*RENOISE_CHUNK_SIZE),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            renoise_chunk_free(renoise_chunk_generate_seeded(call % 64, call / 64, frequency, SEED));
+        }
+        // Run -1 is a warm-up
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+static void bench_world_generate(int64_t world_size, int64_t chunk_size, double frequency) {
+    int64_t inner = world_size - 2;
+    Bench_Result result = {
+        .name = "world_generate",
+        .world_size = world_size,
+        .chunk_size = chunk_size,
+        .frequency = frequency,
+        .chunks_per_call = inner * inner,
+        .calls_per_run = calls_for(inner * inner, chunk_size*chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            renoise_world_free(renoise_world_generate_sized(world_size, frequency, SEED + call, chunk_size));
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+static void bench_world_generate_region(int64_t world_size, int64_t chunk_size, double frequency) {
+    // A 3x3 window in the middle of the world, the rest stays dormant
+    Bench_Result result = {
+        .name = "world_generate_region",
+        .world_size = world_size,
+        .chunk_size = chunk_size,
+        .frequency = frequency,
+        .chunks_per_call = 9,
+        .calls_per_run = calls_for(9, chunk_size*chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            int64_t window = world_size / 2 - 1;
+            renoise_world_free(renoise_world_generate_region(world_size, frequency, SEED + call, chunk_size, window, window, 3, 3));
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+static const char* world_generate_chunk_points_name(Renoise_World* world) {
+    if (world->warp.amplitude > 0.0) return "world_generate_chunk_points_warped";
+    switch (world->noise) {
+    case RENOISE_NOISE_PERLIN:  break;
+    case RENOISE_NOISE_SIMPLEX: return "world_generate_chunk_points_simplex";
+    case RENOISE_NOISE_VALUE:   return "world_generate_chunk_points_value";
+    }
+    return world->chunk_order == RENOISE_CHUNK_ORDER_TILED ? "world_generate_chunk_points_tiled" : "world_generate_chunk_points";
+}
+
+static void bench_world_generate_chunk_points(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    Bench_Result result = {
+        .name = world_generate_chunk_points_name(world),
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = 1,
+        .calls_per_run = calls_for(1, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            int64_t index = call % (inner * inner);
+            renoise_world_generate_chunk_points(world, 1 + index % inner, 1 + index / inner);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+static void bench_world_generate_chunk_points_fixed(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    int16_t* points = malloc(world->chunk_size*world->chunk_size * sizeof(int16_t));
+    Bench_Result result = {
+        .name = "world_generate_chunk_points_fixed",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = 1,
+        .calls_per_run = calls_for(1, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            int64_t index = call % (inner * inner);
+            renoise_world_generate_chunk_points_fixed(world, 1 + index % inner, 1 + index / inner, points, world->chunk_size);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+    free(points);
+}
+
+static void bench_world_generate_chunk_points_derivatives(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    double* points = malloc(3 * world->chunk_size*world->chunk_size * sizeof(double));
+    double* d_dx = points + world->chunk_size*world->chunk_size;
+    double* d_dy = d_dx + world->chunk_size*world->chunk_size;
+    Bench_Result result = {
+        .name = "world_generate_chunk_points_derivatives",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = 1,
+        .calls_per_run = calls_for(1, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            int64_t index = call % (inner * inner);
+            renoise_world_generate_chunk_points_derivatives(world, 1 + index % inner, 1 + index / inner, points, d_dx, d_dy, world->chunk_size);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+    free(points);
+}
+
+static void bench_regenerate_rect(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    Bench_Result result = {
+        .name = "regenerate_rect",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = inner * inner,
+        .calls_per_run = calls_for(inner * inner, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            renoise_world_regenerate_rect(world, 1, 1, inner, inner);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+// The same regeneration, but one chunk per step, so the difference is the overhead of time slicing
+static void bench_regenerate_rect_sliced(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    Bench_Result result = {
+        .name = "regenerate_rect_sliced",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = inner * inner,
+        .calls_per_run = calls_for(inner * inner, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            Renoise_Regeneration regeneration = renoise_world_begin_regenerate_rect(world, 1, 1, inner, inner);
+            while (!renoise_regeneration_step(&regeneration, (Renoise_Work_Budget) { .samples = 1 }));
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+// One frame of a cross-fade over all inner chunks, to compare with regenerate_rect
+static void bench_crossfade_set(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    Renoise_Crossfade* crossfade = renoise_world_crossfade_rect(world, 1, 1, inner, inner);
+    Bench_Result result = {
+        .name = "crossfade_set",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = inner * inner,
+        .calls_per_run = calls_for(inner * inner, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            renoise_crossfade_set(crossfade, (double) call / result.calls_per_run);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+    renoise_crossfade_set(crossfade, 1.0);
+    renoise_crossfade_free(crossfade);
+}
+
+static void bench_regenerate_full_chunk(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    // Regenerating a full chunk recomputes the points of the 3x3 chunks around it
+    Bench_Result result = {
+        .name = world->chunk_order == RENOISE_CHUNK_ORDER_TILED ? "regenerate_full_chunk_tiled" : "regenerate_full_chunk",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = 9,
+        .calls_per_run = calls_for(9, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            int64_t index = call % (inner * inner);
+            renoise_world_regenerate_full_chunk(world, 1 + index % inner, 1 + index / inner);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+static void bench_publish_full_chunk(Renoise_World* world) {
+    int64_t inner = world->size - 2;
+    // Same as regenerate_full_chunk, plus copying the 3x3 changed chunks out for snapshots
+    Bench_Result result = {
+        .name = "publish_full_chunk",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = 9,
+        .calls_per_run = calls_for(9, world->chunk_size*world->chunk_size),
+    };
+    renoise_world_publish(world);
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            int64_t index = call % (inner * inner);
+            renoise_world_regenerate_full_chunk(world, 1 + index % inner, 1 + index / inner);
+            renoise_world_publish(world);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+static void bench_snapshot(Renoise_World* world) {
+    // Taking and dropping a snapshot is one reference on the published table; nothing gets copied
+    Bench_Result result = {
+        .name = "snapshot",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = world->size * world->size,
+        .calls_per_run = calls_for(world->size * world->size, world->chunk_size*world->chunk_size),
+    };
+    renoise_world_publish(world);
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            renoise_snapshot_free(renoise_world_snapshot(world));
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+}
+
+static void bench_visibility_update(Renoise_World* world) {
+    // A view frustum three chunks deep turning around the middle of the world; measured per chunk of the world, which
+    // is what scanning every chunk would cost per call
+    Renoise_Visibility* visibility = renoise_visibility_create(world);
+    double center = world->size * world->chunk_size / 2.0;
+    double reach = 3.0 * world->chunk_size;
+    Bench_Result result = {
+        .name = "visibility_update",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .samples_per_chunk = 1,
+        .chunks_per_call = world->size * world->size,
+        .calls_per_run = calls_for(world->size * world->size, 1),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            double angle = call * 0.01;
+            Renoise_View view = { .kind = RENOISE_VIEW_TRIANGLE };
+            view.points[0] = (Renoise_Vector) { center, center };
+            view.points[1] = (Renoise_Vector) { center + cos(angle - 0.8) * reach, center + sin(angle - 0.8) * reach };
+            view.points[2] = (Renoise_Vector) { center + cos(angle + 0.8) * reach, center + sin(angle + 0.8) * reach };
+            renoise_visibility_update(visibility, &view, 1);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+    renoise_visibility_free(visibility);
+}
+
+static void bench_read_region(Renoise_World* world) {
+    int64_t world_samples = world->size * world->chunk_size;
+    double* points = malloc(world_samples*world_samples * sizeof(double));
+    Bench_Result result = {
+        .name = world->plane != NULL ? "read_region_plane" : "read_region",
+        .world_size = world->size,
+        .chunk_size = world->chunk_size,
+        .frequency = world->frequency,
+        .chunks_per_call = world->size * world->size,
+        .calls_per_run = calls_for(world->size * world->size, world->chunk_size*world->chunk_size),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            renoise_world_read_region(world, (Renoise_Rect) { 0, 0, world_samples, world_samples }, points, world_samples);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+    free(points);
+}
+
+static void bench_world3_generate_chunk_points(double frequency) {
+    // The smallest 3D world with an inner chunk
+    Renoise_World3* world = renoise_world3_generate_seeded(3, frequency, SEED);
+    int64_t samples_per_chunk = RENOISE_CHUNK_SIZE*RENOISE_CHUNK_SIZE*RENOISE_CHUNK_SIZE;
+    Bench_Result result = {
+        .name = "world3_generate_chunk_points",
+        .world_size = world->size,
+        .frequency = frequency,
+        .chunks_per_call = 1,
+        .samples_per_chunk = samples_per_chunk,
+        .calls_per_run = calls_for(1, samples_per_chunk),
+    };
+    for (int run = -1; run < RUNS; ++run) {
+        double start = now_ns();
+        for (int64_t call = 0; call < result.calls_per_run; ++call) {
+            renoise_world3_generate_chunk_points(world, 1, 1, 1);
+        }
+        if (run >= 0) result.run_ns[run] = now_ns() - start;
+    }
+    report(&result);
+    renoise_world3_free(world);
+}
+
+int main(void) {
+    for (size_t f = 0; f < sizeof(frequencies)/sizeof(frequencies[0]); ++f) {
+        double frequency = frequencies[f];
+        if (RENOISE_CHUNK_SIZE * frequency < 1.0) continue;
+
+        bench_chunk_generate(frequency);
+        bench_world3_generate_chunk_points(frequency);
+    }
+
+    for (size_t c = 0; c < sizeof(chunk_sizes)/sizeof(chunk_sizes[0]); ++c) {
+        int64_t chunk_size = chunk_sizes[c];
+        for (size_t f = 0; f < sizeof(frequencies)/sizeof(frequencies[0]); ++f) {
+            double frequency = frequencies[f];
+            if (chunk_size * frequency < 1.0) continue;
+
+            for (size_t w = 0; w < sizeof(world_sizes)/sizeof(world_sizes[0]); ++w) {
+                int64_t world_size = world_sizes[w];
+                int64_t world_samples = world_size*world_size * chunk_size*chunk_size;
+                if (world_samples > MAX_WORLD_SAMPLES) continue;
+
+                bench_world_generate(world_size, chunk_size, frequency);
+                bench_world_generate_region(world_size, chunk_size, frequency);
+                Renoise_World* world = renoise_world_generate_sized(world_size, frequency, SEED, chunk_size);
+                bench_world_generate_chunk_points(world);
+                bench_world_generate_chunk_points_derivatives(world);
+                bench_regenerate_rect(world);
+                bench_regenerate_rect_sliced(world);
+                bench_crossfade_set(world);
+                bench_regenerate_full_chunk(world);
+                bench_publish_full_chunk(world);
+                bench_snapshot(world);
+                bench_visibility_update(world);
+                bench_read_region(world);
+                renoise_world_set_noise(world, RENOISE_NOISE_SIMPLEX);
+                bench_world_generate_chunk_points(world);
+                renoise_world_set_noise(world, RENOISE_NOISE_VALUE);
+                bench_world_generate_chunk_points(world);
+                renoise_world_set_noise(world, RENOISE_NOISE_PERLIN);
+                renoise_world_set_warp(world, (Renoise_Warp) { .amplitude = chunk_size, .frequency = frequency / 4, .seed = SEED });
+                bench_world_generate_chunk_points(world);
+                renoise_world_free(world);
+
+                Renoise_World* tiled_world = renoise_world_generate_sized(world_size, frequency, SEED, chunk_size);
+                renoise_world_set_chunk_order(tiled_world, RENOISE_CHUNK_ORDER_TILED);
+                bench_world_generate_chunk_points(tiled_world);
+                bench_regenerate_full_chunk(tiled_world);
+                renoise_world_free(tiled_world);
+
+                Renoise_World* plane_world = renoise_world_generate_plane(world_size, frequency, SEED, chunk_size);
+                bench_read_region(plane_world);
+                renoise_world_free(plane_world);
+
+                Renoise_World* fixed_world = renoise_world_generate_fixed(world_size, frequency * 65536, SEED, chunk_size);
+                bench_world_generate_chunk_points_fixed(fixed_world);
+                renoise_world_free(fixed_world);
+            }
+        }
+    }
+    return 0;
+}
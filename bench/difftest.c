@@ -0,0 +1,1125 @@
+// Copyright (C) 2025  gstaaij
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Differential tester: runs every kernel and storage path that produces points side by side with the scalar
+// reference implementation, on random seeds, frequencies and regeneration sequences.
+// For every kernel it prints one JSON object with the maximum error and the maximum seam error (how much the step
+// between two samples on either side of a chunk border differs from the reference), and exits with 1 if a kernel
+// is outside its tolerance. Build and run it with `./nob difftest [trials] [seed]`.
+
+#include <renoise.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+
+#define MAX_OPERATIONS 8
+
+// Every trial picks one: the specialised kernels and, with 24, the generic one
+static const int64_t chunk_sizes[] = { 8, 16, 24, 32 };
+#define CHUNK_SIZE_COUNT (sizeof(chunk_sizes)/sizeof(chunk_sizes[0]))
+// The chunk size of the current trial's worlds
+static int64_t chunk_size;
+// The frequency of the current trial's worlds in 16.16 fixed point when they're fixed-point worlds, 0 otherwise
+static uint32_t frequency_q16;
+// The kind of noise and the warp of the current trial's worlds
+static Renoise_Noise noise;
+static Renoise_Warp warp;
+
+// Gives a world the noise and warp of the current trial
+static Renoise_World* set_trial_noise(Renoise_World* world) {
+    if (noise != RENOISE_NOISE_PERLIN) renoise_world_set_noise(world, noise);
+    if (warp.amplitude > 0.0) renoise_world_set_warp(world, warp);
+    return world;
+}
+
+static Renoise_World* generate_world(int64_t world_size, double frequency, uint64_t seed) {
+    if (frequency_q16 != 0) return set_trial_noise(renoise_world_generate_fixed(world_size, frequency_q16, seed, chunk_size));
+    return set_trial_noise(renoise_world_generate_sized(world_size, frequency, seed, chunk_size));
+}
+
+// The original per-sample implementation of renoise_world_generate_chunk_points, kept as-is as the reference
+static double reference_perlin_function(double t) {
+    t = fabs(t);
+    if (t >= 1.0) return 0.0;
+    return 1 - (3 - 2*t) * t*t;
+}
+
+static double reference_perlin_falloff(double x, double y, Renoise_Vector gradient) {
+    return reference_perlin_function(x) * reference_perlin_function(y) * (x * gradient.x + y * gradient.y);
+}
+
+static Renoise_Chunk* reference_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    Renoise_Chunk* chunk = world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)];
+    assert(chunk->grad_points != NULL);
+    return chunk;
+}
+
+static Renoise_Vector reference_grad_point(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t grid_x, int64_t grid_y) {
+    Renoise_Chunk* query_chunk = reference_chunk(world, chunk_x, chunk_y);
+    int64_t query_x = grid_x;
+    int64_t query_y = grid_y;
+    int64_t current_chunk_x = chunk_x;
+    int64_t current_chunk_y = chunk_y;
+    while (query_x < 0) {
+        current_chunk_x -= 1;
+        query_chunk = reference_chunk(world, current_chunk_x, current_chunk_y);
+        query_x = query_chunk->grad_point_count_x - 1;
+    }
+    while (query_x >= query_chunk->grad_point_count_x) {
+        current_chunk_x += 1;
+        query_chunk = reference_chunk(world, current_chunk_x, current_chunk_y);
+        query_x = 0;
+    }
+    while (query_y < 0) {
+        current_chunk_y -= 1;
+        query_chunk = reference_chunk(world, current_chunk_x, current_chunk_y);
+        query_y = query_chunk->grad_point_count_y - 1;
+    }
+    while (query_y >= query_chunk->grad_point_count_y) {
+        current_chunk_y += 1;
+        query_chunk = reference_chunk(world, current_chunk_x, current_chunk_y);
+        query_y = 0;
+    }
+    return query_chunk->grad_points[query_x + query_y * query_chunk->grad_point_count_x];
+}
+
+// Simplex noise from its definition rather than from the library's triangles: every lattice point within sqrt(1/2)
+// of the sample adds (1/2 - d^2)^4 times the dot product of its gradient with the offset d, scaled by 108 to stay
+// within [-1, 1]. Going over the lattice points row by row adds the ones in reach in the same order as the library
+// visits the corners of its triangle, so the two still match exactly. The scale, the lattice and the hashing are
+// pinned down on their own by check_noise_golden.
+static double reference_simplex_point(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, Renoise_Vector grad_coord) {
+    int64_t grad_cell_x = floor(grad_coord.x);
+    int64_t grad_cell_y = floor(grad_coord.y);
+    // Offsets are taken within the cell first, like the library does, so they round the same
+    double x = grad_coord.x - grad_cell_x;
+    double y = grad_coord.y - grad_cell_y;
+    double point = 0.0;
+    for (int64_t grid_y = grad_cell_y - 1; grid_y <= grad_cell_y + 2; ++grid_y) {
+        for (int64_t grid_x = grad_cell_x - 1; grid_x <= grad_cell_x + 2; ++grid_x) {
+            double dx = x - (grid_x - grad_cell_x);
+            double dy = y - (grid_y - grad_cell_y);
+            double t = 0.5 - dx*dx - dy*dy;
+            if (t <= 0.0) continue;
+            Renoise_Vector gradient = reference_grad_point(world, chunk_x, chunk_y, grid_x, grid_y);
+            point += (t*t) * (t*t) * (dx * gradient.x + dy * gradient.y);
+        }
+    }
+    return point * 108.0;
+}
+
+// Value noise: the lattice values (the x of each gradient point) interpolated bilinearly with a smoothstep. This is
+// the plain textbook form and so is the library's; check_noise_golden pins the library's values down on their own.
+static double reference_value_point(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, Renoise_Vector grad_coord) {
+    int64_t grad_cell_x = floor(grad_coord.x);
+    int64_t grad_cell_y = floor(grad_coord.y);
+    double x = grad_coord.x - grad_cell_x;
+    double y = grad_coord.y - grad_cell_y;
+    double fade_x = (3 - 2*x) * x*x;
+    double fade_y = (3 - 2*y) * y*y;
+    double top_left = reference_grad_point(world, chunk_x, chunk_y, grad_cell_x, grad_cell_y).x;
+    double top_right = reference_grad_point(world, chunk_x, chunk_y, grad_cell_x + 1, grad_cell_y).x;
+    double bottom_left = reference_grad_point(world, chunk_x, chunk_y, grad_cell_x, grad_cell_y + 1).x;
+    double bottom_right = reference_grad_point(world, chunk_x, chunk_y, grad_cell_x + 1, grad_cell_y + 1).x;
+    double top = top_left + (top_right - top_left) * fade_x;
+    double bottom = bottom_left + (bottom_right - bottom_left) * fade_x;
+    return top + (bottom - top) * fade_y;
+}
+
+static double reference_point(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, Renoise_Vector grad_coord) {
+    int64_t grad_cell_x = floor(grad_coord.x);
+    int64_t grad_cell_y = floor(grad_coord.y);
+    double point = 0.0;
+    switch (world->noise) {
+    case RENOISE_NOISE_PERLIN:
+        for (int64_t grid_x = grad_cell_x; grid_x <= grad_cell_x + 1; ++grid_x) {
+            for (int64_t grid_y = grad_cell_y; grid_y <= grad_cell_y + 1; ++grid_y) {
+                Renoise_Vector grad_point = reference_grad_point(world, chunk_x, chunk_y, grid_x, grid_y);
+                point += reference_perlin_falloff(grad_coord.x - grid_x, grad_coord.y - grid_y, grad_point);
+            }
+        }
+        break;
+    case RENOISE_NOISE_SIMPLEX:
+        point = reference_simplex_point(world, chunk_x, chunk_y, grad_coord);
+        break;
+    case RENOISE_NOISE_VALUE:
+        point = reference_value_point(world, chunk_x, chunk_y, grad_coord);
+        break;
+    }
+    return point;
+}
+
+// Warped: one warp noise sample per axis at the sample's position, then the world's noise wherever that lands
+static double reference_warped_point(Renoise_World* world, int64_t x, int64_t y) {
+    Renoise_Warp warp = world->warp;
+    double warp_coord_x = x * warp.frequency;
+    double warp_coord_y = y * warp.frequency;
+    int64_t warp_cell_x = floor(warp_coord_x);
+    int64_t warp_cell_y = floor(warp_coord_y);
+    double displacement[2] = { 0.0, 0.0 };
+    for (int64_t grid_x = warp_cell_x; grid_x <= warp_cell_x + 1; ++grid_x) {
+        for (int64_t grid_y = warp_cell_y; grid_y <= warp_cell_y + 1; ++grid_y) {
+            for (int axis = 0; axis < 2; ++axis) {
+                Renoise_Vector grad_point = renoise_gradient_point_fixed_from_seed(warp.seed, grid_x, grid_y, axis, 0);
+                displacement[axis] += reference_perlin_falloff(warp_coord_x - grid_x, warp_coord_y - grid_y, grad_point);
+            }
+        }
+    }
+
+    double limit = (world->size - 1)*chunk_size - 1;
+    double warped_x = fmin(fmax(x + displacement[0] * M_SQRT2 * warp.amplitude, 0.0), limit);
+    double warped_y = fmin(fmax(y + displacement[1] * M_SQRT2 * warp.amplitude, 0.0), limit);
+    int64_t chunk_x = floor(warped_x / chunk_size);
+    int64_t chunk_y = floor(warped_y / chunk_size);
+    Renoise_Chunk* chunk = reference_chunk(world, chunk_x, chunk_y);
+    Renoise_Vector grad_coord = {
+        .x = (warped_x - chunk_x*chunk_size) * chunk->frequency - chunk->grad_offset_x,
+        .y = (warped_y - chunk_y*chunk_size) * chunk->frequency - chunk->grad_offset_y,
+    };
+    return reference_point(world, chunk_x, chunk_y, grad_coord);
+}
+
+static void reference_chunk_points(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, double* plane, int64_t stride) {
+    Renoise_Chunk* chunk = reference_chunk(world, chunk_x, chunk_y);
+
+    for (int64_t chunk_point_x = 0; chunk_point_x < chunk_size; ++chunk_point_x) {
+        for (int64_t chunk_point_y = 0; chunk_point_y < chunk_size; ++chunk_point_y) {
+            double point;
+            if (world->warp.amplitude > 0.0) {
+                point = reference_warped_point(world, chunk_x*chunk_size + chunk_point_x, chunk_y*chunk_size + chunk_point_y);
+            } else {
+                Renoise_Vector grad_coord = {
+                    .x = chunk_point_x * chunk->frequency - chunk->grad_offset_x,
+                    .y = chunk_point_y * chunk->frequency - chunk->grad_offset_y,
+                };
+                point = reference_point(world, chunk_x, chunk_y, grad_coord);
+            }
+            plane[(chunk_y*chunk_size + chunk_point_y) * stride + chunk_x*chunk_size + chunk_point_x] = point;
+        }
+    }
+}
+
+// Per-sample 3D reference, written like the 2D one: walk to the owning chunk for each of the eight corners
+static double reference3_point(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z, int64_t x, int64_t y, int64_t z) {
+    Renoise_Chunk3* chunk = renoise_world3_get_chunk(world, chunk_x, chunk_y, chunk_z);
+    double grad_coord[3] = {
+        x * chunk->frequency - chunk->grad_offset_x,
+        y * chunk->frequency - chunk->grad_offset_y,
+        z * chunk->frequency - chunk->grad_offset_z,
+    };
+    double point = 0.0;
+    for (int corner = 0; corner < 8; ++corner) {
+        int64_t grid[3];
+        int64_t query[3];
+        int64_t current[3] = { chunk_x, chunk_y, chunk_z };
+        for (int axis = 0; axis < 3; ++axis) {
+            grid[axis] = (int64_t) floor(grad_coord[axis]) + ((corner >> axis) & 1);
+            query[axis] = grid[axis];
+        }
+        Renoise_Chunk3* query_chunk = chunk;
+        for (int axis = 0; axis < 3; ++axis) {
+            int64_t* counts = &query_chunk->grad_point_count_x;
+            if (query[axis] < 0) {
+                current[axis] -= 1;
+                query_chunk = renoise_world3_get_chunk(world, current[0], current[1], current[2]);
+                counts = &query_chunk->grad_point_count_x;
+                query[axis] = counts[axis] - 1;
+            } else if (query[axis] >= counts[axis]) {
+                current[axis] += 1;
+                query_chunk = renoise_world3_get_chunk(world, current[0], current[1], current[2]);
+                query[axis] = 0;
+            }
+        }
+        Renoise_Vector3 grad_point = query_chunk->grad_points[query[0] + (query[1] + query[2] * query_chunk->grad_point_count_y) * query_chunk->grad_point_count_x];
+        double distance[3];
+        for (int axis = 0; axis < 3; ++axis) distance[axis] = grad_coord[axis] - grid[axis];
+        point += reference_perlin_function(distance[0]) * reference_perlin_function(distance[1]) * reference_perlin_function(distance[2])
+            * (distance[0] * grad_point.x + distance[1] * grad_point.y + distance[2] * grad_point.z);
+    }
+    return point;
+}
+
+// Compares the vectorised 3D kernel against reference3_point, after a random regeneration sequence
+static void check_kernel3(uint64_t seed, double frequency, double* max_error, double* max_seam_error) {
+    Renoise_World3* world = renoise_world3_generate_seeded(4, frequency, seed);
+    renoise_world3_regenerate_full_chunk(world, 1, 2, 1);
+    renoise_world3_regenerate_box(world, 0, 1, 1, 3, 2, 3);
+    for (int64_t chunk_z = 1; chunk_z < world->size - 1; ++chunk_z) {
+        for (int64_t chunk_y = 1; chunk_y < world->size - 1; ++chunk_y) {
+            for (int64_t chunk_x = 1; chunk_x < world->size - 1; ++chunk_x) {
+                Renoise_Chunk3* chunk = renoise_world3_get_chunk(world, chunk_x, chunk_y, chunk_z);
+                for (int64_t z = 0; z < RENOISE_CHUNK_SIZE; ++z) {
+                    for (int64_t y = 0; y < RENOISE_CHUNK_SIZE; ++y) {
+                        for (int64_t x = 0; x < RENOISE_CHUNK_SIZE; ++x) {
+                            double reference = reference3_point(world, chunk_x, chunk_y, chunk_z, x, y, z);
+                            // The points are floats
+                            double error = fabs(chunk->points[z][y][x] - reference);
+                            if (error > *max_error) *max_error = error;
+                        }
+                        if (chunk_x + 1 < world->size - 1) {
+                            Renoise_Chunk3* next = renoise_world3_get_chunk(world, chunk_x + 1, chunk_y, chunk_z);
+                            double step = next->points[z][y][0] - chunk->points[z][y][RENOISE_CHUNK_SIZE - 1];
+                            double reference_step = reference3_point(world, chunk_x + 1, chunk_y, chunk_z, 0, y, z) - reference3_point(world, chunk_x, chunk_y, chunk_z, RENOISE_CHUNK_SIZE - 1, y, z);
+                            double seam_error = fabs(step - reference_step);
+                            if (seam_error > *max_seam_error) *max_seam_error = seam_error;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    renoise_world3_free(world);
+}
+
+// A kernel writes the points of every inner chunk of the world into `plane`, a row-major image of the whole world
+typedef void (*Kernel_Function)(Renoise_World* world, double* plane, int64_t stride);
+
+static void copy_chunk_points(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, double* plane, int64_t stride) {
+    Renoise_Chunk* chunk = renoise_world_get_chunk(world, chunk_x, chunk_y);
+    for (int64_t y = 0; y < chunk_size; ++y) {
+        memcpy(&plane[(chunk_y*chunk_size + y) * stride + chunk_x*chunk_size], &chunk->points[y * chunk->points_stride], chunk_size * sizeof(double));
+    }
+}
+
+#define FOR_INNER_CHUNKS(world) \
+    for (int64_t chunk_y = 1; chunk_y < (world)->size - 1; ++chunk_y) \
+        for (int64_t chunk_x = 1; chunk_x < (world)->size - 1; ++chunk_x)
+
+// The points as the regeneration sequence left them, which tests the incremental updates
+static void kernel_stored_points(Renoise_World* world, double* plane, int64_t stride) {
+    FOR_INNER_CHUNKS(world) copy_chunk_points(world, chunk_x, chunk_y, plane, stride);
+}
+
+static void kernel_generate_chunk_points(Renoise_World* world, double* plane, int64_t stride) {
+    FOR_INNER_CHUNKS(world) {
+        renoise_world_generate_chunk_points(world, chunk_x, chunk_y);
+        copy_chunk_points(world, chunk_x, chunk_y, plane, stride);
+    }
+}
+
+static void kernel_quantized(Renoise_World* world, double* plane, int64_t stride, Renoise_Quantize quantize) {
+    FOR_INNER_CHUNKS(world) {
+        uint8_t uint8_points[chunk_size*chunk_size];
+        int16_t int16_points[chunk_size*chunk_size];
+        void* points = quantize.format == RENOISE_QUANTIZE_UINT8 ? (void*) uint8_points : (void*) int16_points;
+        renoise_world_generate_chunk_points_quantized(world, chunk_x, chunk_y, quantize, points, chunk_size);
+        for (int64_t i = 0; i < chunk_size*chunk_size; ++i) {
+            double value = quantize.format == RENOISE_QUANTIZE_UINT8 ? uint8_points[i] : int16_points[i];
+            plane[(chunk_y*chunk_size + i/chunk_size) * stride + chunk_x*chunk_size + i%chunk_size] = (value - quantize.bias) / quantize.scale;
+        }
+    }
+}
+
+static void kernel_quantized_uint8(Renoise_World* world, double* plane, int64_t stride) {
+    kernel_quantized(world, plane, stride, renoise_quantize_default(RENOISE_QUANTIZE_UINT8));
+}
+
+static void kernel_quantized_int16(Renoise_World* world, double* plane, int64_t stride) {
+    kernel_quantized(world, plane, stride, renoise_quantize_default(RENOISE_QUANTIZE_INT16));
+}
+
+static void kernel_idle_eviction(Renoise_World* world, double* plane, int64_t stride) {
+    world->cold_after = 1;
+    uint64_t evictions = world->cache.evictions;
+    renoise_world_tick(world);
+    renoise_world_tick(world);
+    // Every chunk got evicted once, and only once
+    assert(world->cache.evictions - evictions == (uint64_t) (world->size*world->size));
+    FOR_INNER_CHUNKS(world) assert(renoise_chunk_is_evicted(world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)]));
+    FOR_INNER_CHUNKS(world) copy_chunk_points(world, chunk_x, chunk_y, plane, stride);
+    world->cold_after = 0;
+}
+
+static void kernel_memory_budget(Renoise_World* world, double* plane, int64_t stride) {
+    // Room for a handful of chunks, so almost every access rebuilds an evicted chunk
+    renoise_world_set_memory_budget(world, 4 * chunk_size*chunk_size * sizeof(double));
+    FOR_INNER_CHUNKS(world) copy_chunk_points(world, chunk_x, chunk_y, plane, stride);
+    renoise_world_set_memory_budget(world, 0);
+}
+
+// A replay kernel builds a second world with the same seed and parameters and brings it to the same state by
+// replaying the first world's journal. The callbacks cover the different ways to build, change and read that world;
+// the NULL ones do the plain thing: generate_world, renoise_world_replay and copy_chunk_points.
+typedef struct {
+    Renoise_World* (*setup)(Renoise_World* world);
+    // Called for every applied operation of the journal instead of replaying it in one go
+    void (*apply)(Renoise_World* replayed, Renoise_Operation operation);
+    void (*read)(Renoise_World* replayed, double* plane, int64_t stride);
+    // Called after the replayed world got freed
+    void (*after_free)(double* plane, int64_t stride);
+} Replay;
+
+static void kernel_replay(const Replay* replay, Renoise_World* world, double* plane, int64_t stride) {
+    Renoise_World* replayed = replay->setup != NULL ? replay->setup(world) : generate_world(world->size, world->frequency, world->seed);
+    if (replay->apply != NULL) {
+        for (int64_t i = 0; i < world->journal->position; ++i) replay->apply(replayed, world->journal->entries[i].operation);
+    } else {
+        renoise_world_replay(replayed, world->journal);
+    }
+    if (replay->read != NULL) {
+        replay->read(replayed, plane, stride);
+    } else {
+        FOR_INNER_CHUNKS(replayed) copy_chunk_points(replayed, chunk_x, chunk_y, plane, stride);
+    }
+    renoise_world_free(replayed);
+    if (replay->after_free != NULL) replay->after_free(plane, stride);
+}
+
+static Renoise_World* replay_setup_plane(Renoise_World* world) {
+    return set_trial_noise(renoise_world_generate_plane(world->size, world->frequency, world->seed, world->chunk_size));
+}
+
+static void replay_read_region(Renoise_World* replayed, double* plane, int64_t stride) {
+    renoise_world_read_region(replayed, (Renoise_Rect) { 0, 0, stride, stride }, plane, stride);
+}
+
+static Renoise_World* replay_setup_region(Renoise_World* world) {
+    // Only the middle chunk is generated up front, everything else when the replay or the copy first needs it
+    int64_t middle = world->size / 2;
+    return set_trial_noise(renoise_world_generate_region(world->size, world->frequency, world->seed, chunk_size, middle, middle, 1, 1));
+}
+
+static void replay_read_generated(Renoise_World* replayed, double* plane, int64_t stride) {
+    FOR_INNER_CHUNKS(replayed) {
+        copy_chunk_points(replayed, chunk_x, chunk_y, plane, stride);
+        assert(renoise_world_chunk_version(replayed, chunk_x, chunk_y) != 0);
+    }
+}
+
+static Renoise_World* replay_setup_tiled(Renoise_World* world) {
+    Renoise_World* replayed = generate_world(world->size, world->frequency, world->seed);
+    renoise_world_set_chunk_order(replayed, RENOISE_CHUNK_ORDER_TILED);
+    return replayed;
+}
+
+static void replay_apply_sliced(Renoise_World* replayed, Renoise_Operation operation) {
+    // In steps of one chunk, the smallest step there is
+    Renoise_Regeneration regeneration = renoise_world_begin_operation(replayed, operation);
+    double progress = renoise_regeneration_progress(&regeneration);
+    while (!renoise_regeneration_step(&regeneration, (Renoise_Work_Budget) { .samples = 1 })) {
+        assert(renoise_regeneration_progress(&regeneration) > progress);
+        progress = renoise_regeneration_progress(&regeneration);
+    }
+    assert(renoise_regeneration_progress(&regeneration) == 1.0);
+}
+
+static void replay_apply_crossfade(Renoise_World* replayed, Renoise_Operation operation) {
+    // The library's own accesses don't count as cache traffic
+    Renoise_Cache_Counters cache = replayed->cache;
+    Renoise_Crossfade* crossfade = renoise_world_begin_crossfade(replayed, operation);
+    renoise_crossfade_set(crossfade, 0.25);
+    renoise_crossfade_set(crossfade, 0.75);
+    renoise_crossfade_set(crossfade, 1.0);
+    renoise_crossfade_free(crossfade);
+    assert(replayed->cache.hits == cache.hits && replayed->cache.misses == cache.misses);
+}
+
+// Publishes after every operation with the previous snapshot still alive, then keeps changing the world and frees
+// it before reading the last snapshot, which must not see any of that
+static Renoise_Snapshot* replay_snapshot;
+
+static Renoise_World* replay_setup_snapshot(Renoise_World* world) {
+    Renoise_World* replayed = generate_world(world->size, world->frequency, world->seed);
+    renoise_world_publish(replayed);
+    // Publishing again without changes must leave evicted chunks evicted
+    replayed->cold_after = 1;
+    renoise_world_tick(replayed);
+    renoise_world_tick(replayed);
+    renoise_world_publish(replayed);
+    FOR_INNER_CHUNKS(replayed) assert(renoise_chunk_is_evicted(replayed->chunks[renoise_world_chunk_index(replayed, chunk_x, chunk_y)]));
+    replayed->cold_after = 0;
+    replay_snapshot = renoise_world_snapshot(replayed);
+    return replayed;
+}
+
+static void replay_apply_snapshot(Renoise_World* replayed, Renoise_Operation operation) {
+    renoise_world_apply_operation(replayed, operation);
+    Renoise_Cache_Counters cache = replayed->cache;
+    renoise_world_publish(replayed);
+    assert(replayed->cache.hits == cache.hits && replayed->cache.misses == cache.misses);
+    renoise_snapshot_free(replay_snapshot);
+    replay_snapshot = renoise_world_snapshot(replayed);
+}
+
+static void replay_read_snapshot(Renoise_World* replayed, double* plane, int64_t stride) {
+    (void) plane;
+    (void) stride;
+    assert(replay_snapshot->version == replayed->version);
+    FOR_INNER_CHUNKS(replayed) {
+        assert(renoise_snapshot_chunk_version(replay_snapshot, chunk_x, chunk_y) == renoise_world_chunk_version(replayed, chunk_x, chunk_y));
+    }
+    int64_t inner_samples = (replayed->size - 2) * chunk_size;
+    Renoise_Rect inner = { chunk_size, chunk_size, inner_samples, inner_samples };
+    assert(renoise_world_region_version(replayed, inner) == replayed->version);
+    renoise_world_regenerate_rect(replayed, 1, 1, replayed->size - 2, replayed->size - 2);
+    assert(renoise_world_region_version(replayed, inner) > replay_snapshot->version);
+    renoise_world_publish(replayed);
+}
+
+static void replay_after_free_snapshot(double* plane, int64_t stride) {
+    FOR_INNER_CHUNKS(replay_snapshot) {
+        const double* points = renoise_snapshot_chunk_points(replay_snapshot, chunk_x, chunk_y);
+        for (int64_t y = 0; y < chunk_size; ++y) {
+            memcpy(&plane[(chunk_y*chunk_size + y) * stride + chunk_x*chunk_size], &points[y * chunk_size], chunk_size * sizeof(double));
+        }
+    }
+    renoise_snapshot_free(replay_snapshot);
+    replay_snapshot = NULL;
+}
+
+static void kernel_journal_undo_redo(Renoise_World* world, double* plane, int64_t stride) {
+    while (renoise_world_undo(world));
+    while (renoise_world_redo(world));
+    FOR_INNER_CHUNKS(world) copy_chunk_points(world, chunk_x, chunk_y, plane, stride);
+}
+
+static void kernel_read_region(Renoise_World* world, double* plane, int64_t stride) {
+    renoise_world_read_region(world, (Renoise_Rect) { 0, 0, stride, stride }, plane, stride);
+}
+
+// What the quantized readers should give for one point: `quantize` applied to the double point, rounded and
+// saturated to the range of its format
+static int64_t quantize_point(Renoise_Quantize quantize, double point) {
+    double value = round(point * quantize.scale + quantize.bias);
+    double min = quantize.format == RENOISE_QUANTIZE_UINT8 ? 0.0 : INT16_MIN;
+    double max = quantize.format == RENOISE_QUANTIZE_UINT8 ? UINT8_MAX : INT16_MAX;
+    return (int64_t) (value < min ? min : value > max ? max : value);
+}
+
+static void kernel_read_region_float(Renoise_World* world, double* plane, int64_t stride) {
+    float* points = malloc(stride*stride * sizeof(float));
+    renoise_world_read_region_float(world, (Renoise_Rect) { 0, 0, stride, stride }, points, stride);
+    renoise_world_read_region(world, (Renoise_Rect) { 0, 0, stride, stride }, plane, stride);
+    for (int64_t i = 0; i < stride*stride; ++i) {
+        assert(points[i] == (float) plane[i]);
+        plane[i] = points[i];
+    }
+    free(points);
+}
+
+static void kernel_read_region_int16(Renoise_World* world, double* plane, int64_t stride) {
+    // A region that doesn't start on a chunk border and a padded stride, so neither lines up with the chunks
+    Renoise_Rect region = { chunk_size - 3, chunk_size, stride - 2*chunk_size + 6, stride - 2*chunk_size };
+    int64_t points_stride = region.width + 5;
+    int16_t* points = malloc(points_stride*region.height * sizeof(int16_t));
+    renoise_world_read_region_int16(world, region, points, points_stride);
+    renoise_world_read_region(world, region, &plane[region.y * stride + region.x], stride);
+    Renoise_Quantize quantize = renoise_quantize_default(RENOISE_QUANTIZE_INT16);
+    for (int64_t y = 0; y < region.height; ++y) {
+        for (int64_t x = 0; x < region.width; ++x) {
+            double* point = &plane[(region.y + y) * stride + region.x + x];
+            assert(points[x + y * points_stride] == quantize_point(quantize, *point));
+            *point = points[x + y * points_stride] / (double) INT16_MAX;
+        }
+    }
+    free(points);
+}
+
+// Checks the pixels against the palette entries of the quantized points, once grayscale and once with a palette
+// where every channel of every entry differs, and passes the points on unchanged
+static void kernel_rasterize(Renoise_World* world, double* plane, int64_t stride) {
+    Renoise_Rect region = { chunk_size - 3, chunk_size, stride - 2*chunk_size + 6, stride - 2*chunk_size };
+    int64_t rgba_stride = (region.width + 3) * 4;
+    uint8_t* rgba = malloc(rgba_stride*region.height);
+    renoise_world_read_region(world, region, &plane[region.y * stride + region.x], stride);
+    Renoise_Quantize quantize = renoise_quantize_default(RENOISE_QUANTIZE_UINT8);
+
+    Renoise_Palette grayscale = renoise_palette_grayscale();
+    Renoise_Palette shuffled;
+    for (int i = 0; i < 256; ++i) {
+        for (int channel = 0; channel < 4; ++channel) shuffled.colors[i][channel] = (uint8_t) (i * 37 + channel * 101 + 13);
+    }
+    const Renoise_Palette* palettes[] = { NULL, &shuffled };
+    for (size_t p = 0; p < sizeof(palettes)/sizeof(palettes[0]); ++p) {
+        const Renoise_Palette* expected = palettes[p] != NULL ? palettes[p] : &grayscale;
+        renoise_world_rasterize(world, region, rgba, rgba_stride, palettes[p]);
+        for (int64_t y = 0; y < region.height; ++y) {
+            for (int64_t x = 0; x < region.width; ++x) {
+                int64_t value = quantize_point(quantize, plane[(region.y + y) * stride + region.x + x]);
+                assert(memcmp(&rgba[y * rgba_stride + x * 4], expected->colors[value], 4) == 0);
+            }
+        }
+    }
+    free(rgba);
+}
+
+static void kernel_fixed(Renoise_World* world, double* plane, int64_t stride) {
+    FOR_INNER_CHUNKS(world) {
+        int16_t points[chunk_size*chunk_size];
+        renoise_world_generate_chunk_points_fixed(world, chunk_x, chunk_y, points, chunk_size);
+        for (int64_t i = 0; i < chunk_size*chunk_size; ++i) {
+            plane[(chunk_y*chunk_size + i/chunk_size) * stride + chunk_x*chunk_size + i%chunk_size] = points[i] / 32768.0;
+        }
+    }
+}
+
+static void kernel_derivatives(Renoise_World* world, double* plane, int64_t stride) {
+    // The values go through the regular comparison, check_derivatives checks the derivatives themselves
+    double* d_dx = malloc(stride*stride * sizeof(double));
+    double* d_dy = malloc(stride*stride * sizeof(double));
+    FOR_INNER_CHUNKS(world) {
+        renoise_world_generate_chunk_points_derivatives(world, chunk_x, chunk_y, &plane[chunk_y*chunk_size * stride + chunk_x*chunk_size], &d_dx[chunk_y*chunk_size * stride + chunk_x*chunk_size], &d_dy[chunk_y*chunk_size * stride + chunk_x*chunk_size], stride);
+    }
+    double* region_dx = malloc(stride*stride * sizeof(double));
+    double* region_dy = malloc(stride*stride * sizeof(double));
+    renoise_world_read_region_derivatives(world, (Renoise_Rect) { 0, 0, stride, stride }, region_dx, region_dy, stride);
+    for (int64_t y = chunk_size; y < stride - chunk_size; ++y) {
+        for (int64_t x = chunk_size; x < stride - chunk_size; ++x) {
+            assert(region_dx[y*stride + x] == d_dx[y*stride + x] && region_dy[y*stride + x] == d_dy[y*stride + x]);
+        }
+    }
+    free(d_dx);
+    free(d_dy);
+    free(region_dx);
+    free(region_dy);
+}
+
+// The kind of worlds a kernel works on
+typedef enum {
+    WORLDS_ALL,
+    WORLDS_DOUBLE,
+    // Fixed-point worlds with unwarped Perlin noise
+    WORLDS_FIXED_PERLIN,
+} Worlds;
+
+typedef struct {
+    const char* name;
+    // Either a function, or a replay for kernel_replay
+    Kernel_Function function;
+    Replay replay;
+    double tolerance;
+    Worlds worlds;
+    int64_t trials;
+    double max_error;
+    double max_seam_error;
+} Kernel;
+
+static Kernel kernels[] = {
+    { .name = "stored_points",          .function = kernel_stored_points,          .tolerance = 0.0 },
+    { .name = "generate_chunk_points",  .function = kernel_generate_chunk_points,  .tolerance = 0.0 },
+    { .name = "quantized_uint8",        .function = kernel_quantized_uint8,        .tolerance = 0.5 / 127.5 + 1e-12 },
+    { .name = "quantized_int16",        .function = kernel_quantized_int16,        .tolerance = 0.5 / INT16_MAX + 1e-12 },
+    { .name = "idle_eviction",          .function = kernel_idle_eviction,          .tolerance = 0.0 },
+    { .name = "memory_budget",          .function = kernel_memory_budget,          .tolerance = 0.0 },
+    { .name = "journal_replay",         .replay = {0}, .tolerance = 0.0 },
+    { .name = "sliced_replay",          .replay = { .apply = replay_apply_sliced }, .tolerance = 0.0 },
+    { .name = "crossfade_replay",       .replay = { .apply = replay_apply_crossfade }, .tolerance = 0.0 },
+    { .name = "snapshot_replay",        .replay = { .setup = replay_setup_snapshot, .apply = replay_apply_snapshot, .read = replay_read_snapshot, .after_free = replay_after_free_snapshot }, .tolerance = 0.0 },
+    { .name = "journal_undo_redo",      .function = kernel_journal_undo_redo,      .tolerance = 0.0 },
+    { .name = "plane_replay",           .replay = { .setup = replay_setup_plane, .read = replay_read_region }, .tolerance = 0.0, .worlds = WORLDS_DOUBLE },
+    { .name = "region_replay",          .replay = { .setup = replay_setup_region, .read = replay_read_generated }, .tolerance = 0.0, .worlds = WORLDS_DOUBLE },
+    { .name = "tiled_replay",           .replay = { .setup = replay_setup_tiled }, .tolerance = 0.0 },
+    { .name = "read_region",            .function = kernel_read_region,            .tolerance = 0.0 },
+    { .name = "read_region_float",      .function = kernel_read_region_float,      .tolerance = 1e-7 },
+    { .name = "read_region_int16",      .function = kernel_read_region_int16,      .tolerance = 0.5 / INT16_MAX + 1e-12 },
+    { .name = "rasterize",              .function = kernel_rasterize,              .tolerance = 0.0 },
+    { .name = "derivatives",            .function = kernel_derivatives,            .tolerance = 0.0 },
+    { .name = "fixed",                  .function = kernel_fixed,                  .tolerance = 8.0 / 32768, .worlds = WORLDS_FIXED_PERLIN },
+};
+#define KERNEL_COUNT (sizeof(kernels)/sizeof(kernels[0]))
+
+static uint64_t rng_state;
+static uint64_t rng_next() {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1D;
+}
+
+static int64_t rng_range(int64_t min, int64_t max) {
+    return min + rng_next() % (max - min + 1);
+}
+
+// The largest gap between the analytic derivatives and centred differences of the points, relative to the largest
+// derivative of the world. The worlds have big chunks with a whole number of gradient points per chunk, so the
+// lattices of neighbouring chunks line up, and a low frequency, where the error of a centred difference falls with
+// the frequency squared.
+static double max_derivative_error;
+// About 3.5e-4 over 400 trials, from warped simplex noise; dropping the frequency factor, flipping a sign or leaving
+// out the warp gives 0.5 and more
+#define DERIVATIVE_TOLERANCE 1e-3
+
+// With `warped`, the world gets a warp on a lattice as coarse as the noise's, which also checks the chain rule through it
+static void check_derivatives(uint64_t seed, Renoise_Noise derivative_noise, bool warped) {
+    // One gradient point per chunk; at twice that frequency simplex noise already comes close to the tolerance
+    int64_t size = 256;
+    int64_t lattice_spacing = size;
+    Renoise_World* world = renoise_world_generate_sized(4, 1.0 / lattice_spacing, seed, size);
+    if (derivative_noise != RENOISE_NOISE_PERLIN) renoise_world_set_noise(world, derivative_noise);
+    if (warped) renoise_world_set_warp(world, (Renoise_Warp) { .amplitude = 24.0, .frequency = 1.0 / lattice_spacing, .seed = seed });
+    // Samples the warp moves past the edge chunks get clamped, and a centred difference over the clamp means nothing
+    int64_t margin = 1 + ceil(world->warp.amplitude);
+    renoise_world_regenerate_full_chunk(world, rng_range(1, 2), rng_range(1, 2));
+
+    int64_t stride = world->size * size;
+    double* points = malloc(stride*stride * sizeof(double));
+    double* d_dx = malloc(stride*stride * sizeof(double));
+    double* d_dy = malloc(stride*stride * sizeof(double));
+    assert(points != NULL && d_dx != NULL && d_dy != NULL);
+    Renoise_Rect region = { size, size, stride - 2*size, stride - 2*size };
+    renoise_world_read_region(world, region, &points[size*stride + size], stride);
+    renoise_world_read_region_derivatives(world, region, &d_dx[size*stride + size], &d_dy[size*stride + size], stride);
+
+    double max_derivative = 0.0;
+    double max_error = 0.0;
+    for (int64_t y = size + margin; y < stride - size - margin; ++y) {
+        for (int64_t x = size + margin; x < stride - size - margin; ++x) {
+            int64_t i = y*stride + x;
+            // The falloff of Perlin and value noise is only C1, so its second derivative jumps on the lattice lines
+            // and a centred difference over one is off by O(frequency) instead of O(frequency^2). The warp is Perlin
+            // noise too; the lines it moves the noise's lattice onto aren't straight, so warped worlds only get
+            // simplex noise.
+            bool on_lattice_x = (warped || derivative_noise != RENOISE_NOISE_SIMPLEX) && x % lattice_spacing == 0;
+            bool on_lattice_y = (warped || derivative_noise != RENOISE_NOISE_SIMPLEX) && y % lattice_spacing == 0;
+            double error_x = fabs((points[i + 1] - points[i - 1]) / 2 - d_dx[i]);
+            double error_y = fabs((points[i + stride] - points[i - stride]) / 2 - d_dy[i]);
+            if (!on_lattice_x && error_x > max_error) max_error = error_x;
+            if (!on_lattice_y && error_y > max_error) max_error = error_y;
+            if (fabs(d_dx[i]) > max_derivative) max_derivative = fabs(d_dx[i]);
+            if (fabs(d_dy[i]) > max_derivative) max_derivative = fabs(d_dy[i]);
+        }
+    }
+    if (max_derivative > 0.0 && max_error / max_derivative > max_derivative_error) max_derivative_error = max_error / max_derivative;
+
+    free(points);
+    free(d_dx);
+    free(d_dy);
+    renoise_world_free(world);
+}
+
+// Drains every dirty chunk, a few at a time so a drain also has to stop halfway through a word
+static int64_t drain_all_changes(Renoise_World* world, Renoise_Chunk_Change* changes) {
+    int64_t count = 0;
+    for (int64_t drained; (drained = renoise_world_drain_changes(world, &changes[count], 3)) > 0;) count += drained;
+    return count;
+}
+
+// Checks the change feed and the versions: a full chunk regeneration marks exactly the inner chunks of its 3x3
+// neighbourhood, a rect of no chunks marks nothing, and every change gets a higher version than any before it
+static void check_change_feed(uint64_t seed) {
+    Renoise_World* world = renoise_world_generate_sized(rng_range(3, 8), 0.25, seed, 8);
+    Renoise_Rect whole = { 0, 0, world->size * world->chunk_size, world->size * world->chunk_size };
+    Renoise_Chunk_Change* changes = malloc(world->size*world->size * sizeof(*changes));
+    // Generating the world marks its inner chunks
+    assert(drain_all_changes(world, changes) == (world->size - 2) * (world->size - 2));
+    assert(drain_all_changes(world, changes) == 0);
+
+    for (int64_t i = 0; i < 4; ++i) {
+        uint64_t version = renoise_world_region_version(world, whole);
+        int64_t chunk_x = rng_range(1, world->size - 2);
+        int64_t chunk_y = rng_range(1, world->size - 2);
+        renoise_world_regenerate_full_chunk(world, chunk_x, chunk_y);
+        int64_t count = drain_all_changes(world, changes);
+
+        int64_t expected = 0;
+        for (int64_t y = chunk_y - 1; y <= chunk_y + 1; ++y) {
+            for (int64_t x = chunk_x - 1; x <= chunk_x + 1; ++x) {
+                if (x >= 1 && x < world->size - 1 && y >= 1 && y < world->size - 1) expected += 1;
+            }
+        }
+        assert(count == expected);
+        uint64_t max_version = version;
+        for (int64_t c = 0; c < count; ++c) {
+            assert(llabs(changes[c].chunk_x - chunk_x) <= 1 && llabs(changes[c].chunk_y - chunk_y) <= 1);
+            assert(changes[c].version > version);
+            assert(changes[c].version == renoise_world_chunk_version(world, changes[c].chunk_x, changes[c].chunk_y));
+            for (int64_t other = 0; other < c; ++other) assert(changes[other].version != changes[c].version);
+            if (changes[c].version > max_version) max_version = changes[c].version;
+        }
+        assert(renoise_world_region_version(world, whole) == max_version);
+
+        renoise_world_regenerate_rect(world, chunk_x, chunk_y, 0, 0);
+        assert(drain_all_changes(world, changes) == 0);
+        assert(renoise_world_region_version(world, whole) == max_version);
+    }
+
+    free(changes);
+    renoise_world_free(world);
+}
+
+static bool chunk_list_contains(const Renoise_Chunk_List* list, int64_t index) {
+    for (int64_t i = 0; i < list->count; ++i) {
+        if (list->items[i] == index) return true;
+    }
+    return false;
+}
+
+// Whether `list` holds exactly the chunks `expected`, in any order, terminated by { -1, -1 }
+static bool chunk_list_equals(const Renoise_World* world, const Renoise_Chunk_List* list, const int64_t (*expected)[2]) {
+    int64_t count = 0;
+    for (; expected[count][0] >= 0; ++count) {
+        if (!chunk_list_contains(list, expected[count][0] + expected[count][1] * world->size)) return false;
+    }
+    return list->count == count;
+}
+
+// Checks the shown and hidden chunks of visibility updates by hand: an AABB that moves by a chunk, a triangle that
+// stays put and misses the corner chunks of its bounding box, and then no views at all
+static void check_visibility() {
+    Renoise_World* world = renoise_world_generate_sized(8, 0.25, 1, 8);
+    Renoise_Visibility* visibility = renoise_visibility_create(world);
+    const int64_t none[][2] = { { -1, -1 } };
+
+    // The hypotenuse x + y = 103 misses the chunks whose nearest corner sums to more than that: (6, 7), (7, 6), (7, 7)
+    Renoise_View views[] = {
+        { .kind = RENOISE_VIEW_AABB,     .points = { { 4, 4 }, { 20, 12 } } },
+        { .kind = RENOISE_VIEW_TRIANGLE, .points = { { 40, 40 }, { 63, 40 }, { 40, 63 } } },
+    };
+    renoise_visibility_update(visibility, views, 2);
+    const int64_t first[][2] = {
+        { 0, 0 }, { 1, 0 }, { 2, 0 }, { 0, 1 }, { 1, 1 }, { 2, 1 },
+        { 5, 5 }, { 6, 5 }, { 7, 5 }, { 5, 6 }, { 6, 6 }, { 5, 7 }, { -1, -1 },
+    };
+    assert(chunk_list_equals(world, &visibility->visible, first));
+    assert(chunk_list_equals(world, &visibility->shown, first));
+    assert(chunk_list_equals(world, &visibility->hidden, none));
+    assert(renoise_visibility_is_visible(visibility, 6, 6) && !renoise_visibility_is_visible(visibility, 7, 7));
+
+    views[0].points[0].x += 8;
+    views[0].points[1].x += 8;
+    renoise_visibility_update(visibility, views, 2);
+    const int64_t shown[][2] = { { 3, 0 }, { 3, 1 }, { -1, -1 } };
+    const int64_t hidden[][2] = { { 0, 0 }, { 0, 1 }, { -1, -1 } };
+    assert(chunk_list_equals(world, &visibility->shown, shown));
+    assert(chunk_list_equals(world, &visibility->hidden, hidden));
+    assert(visibility->visible.count == 12 && !renoise_visibility_is_visible(visibility, 0, 0));
+
+    // No views hides everything that was visible, and a second empty update changes nothing
+    const int64_t second[][2] = {
+        { 1, 0 }, { 2, 0 }, { 3, 0 }, { 1, 1 }, { 2, 1 }, { 3, 1 },
+        { 5, 5 }, { 6, 5 }, { 7, 5 }, { 5, 6 }, { 6, 6 }, { 5, 7 }, { -1, -1 },
+    };
+    renoise_visibility_update(visibility, NULL, 0);
+    assert(chunk_list_equals(world, &visibility->visible, none));
+    assert(chunk_list_equals(world, &visibility->shown, none));
+    assert(chunk_list_equals(world, &visibility->hidden, second));
+    renoise_visibility_update(visibility, NULL, 0);
+    assert(chunk_list_equals(world, &visibility->hidden, none));
+    for (int64_t i = 0; i < world->size*world->size; ++i) assert(!renoise_visibility_is_visible(visibility, i % world->size, i / world->size));
+
+    renoise_visibility_free(visibility);
+    renoise_world_free(world);
+}
+
+// Moves an AABB view over a world with regenerate_hidden set. Chunks that get hidden must change and show up in the
+// change feed; chunks that stay visible must keep their points and versions, and must not show up in it.
+static void check_visibility_regeneration() {
+    Renoise_World* world = renoise_world_generate_sized(8, 0.5, 2, 8);
+    int64_t chunk_count = world->size*world->size;
+    int64_t point_count = world->chunk_size*world->chunk_size;
+    Renoise_Visibility* visibility = renoise_visibility_create(world);
+    visibility->regenerate_hidden = true;
+    double* points = malloc(chunk_count*point_count * sizeof(double));
+    uint64_t* versions = malloc(chunk_count * sizeof(uint64_t));
+    Renoise_Chunk_Change* changes = malloc(chunk_count * sizeof(*changes));
+    bool* changed = malloc(chunk_count * sizeof(bool));
+
+    // Chunks 1-3 on both axes, then 2-4 along x with 1-3 still along y, then 5-6 on both axes. Hiding x = 1 leaves
+    // visible neighbours, which have to stay as they are; the chunks hidden last have none, so they get a full
+    // chunk regeneration that also changes the hidden chunks around them.
+    const Renoise_Vector views[][2] = { { { 8, 8 }, { 32, 32 } }, { { 16, 8 }, { 40, 32 } }, { { 40, 40 }, { 56, 56 } } };
+    for (size_t step = 0; step < sizeof(views)/sizeof(views[0]); ++step) {
+        drain_all_changes(world, changes);
+        for (int64_t i = 0; i < chunk_count; ++i) {
+            Renoise_Chunk* chunk = renoise_world_get_chunk(world, i % world->size, i / world->size);
+            versions[i] = chunk->version;
+            for (int64_t y = 0; y < chunk->size; ++y) {
+                memcpy(&points[i*point_count + y*chunk->size], &chunk->points[y*chunk->points_stride], chunk->size * sizeof(double));
+            }
+        }
+
+        Renoise_View view = { .kind = RENOISE_VIEW_AABB, .points = { views[step][0], views[step][1] } };
+        renoise_visibility_update(visibility, &view, 1);
+        memset(changed, 0, chunk_count * sizeof(bool));
+        int64_t change_count = drain_all_changes(world, changes);
+        for (int64_t i = 0; i < change_count; ++i) changed[changes[i].chunk_x + changes[i].chunk_y * world->size] = true;
+
+        for (int64_t i = 0; i < chunk_count; ++i) {
+            int64_t chunk_x = i % world->size;
+            int64_t chunk_y = i / world->size;
+            Renoise_Chunk* chunk = renoise_world_get_chunk(world, chunk_x, chunk_y);
+            bool same_points = true;
+            for (int64_t y = 0; y < chunk->size; ++y) {
+                if (memcmp(&points[i*point_count + y*chunk->size], &chunk->points[y*chunk->points_stride], chunk->size * sizeof(double)) != 0) same_points = false;
+            }
+            if (renoise_visibility_is_visible(visibility, chunk_x, chunk_y)) {
+                assert(same_points && chunk->version == versions[i] && !changed[i] && "ERROR: A visible chunk changed");
+            } else if (chunk_list_contains(&visibility->hidden, i) && chunk_x > 0 && chunk_y > 0) {
+                assert(!same_points && chunk->version > versions[i] && changed[i] && "ERROR: A hidden chunk didn't get regenerated");
+            }
+        }
+        // (1, 4) is only next to chunks hidden beside visible ones, (1, 1) next to ones that get a full regeneration
+        if (step == 1) assert(!changed[1 + 4*world->size]);
+        if (step == 2) assert(changed[1 + 1*world->size]);
+    }
+
+    free(points);
+    free(versions);
+    free(changes);
+    free(changed);
+    renoise_visibility_free(visibility);
+    renoise_world_free(world);
+}
+
+// Checks the counters of one call by the difference of two snapshots, since they're accumulated over the whole run
+static void check_stats(uint64_t seed) {
+    Renoise_World* world = renoise_world_generate_sized(4, 0.25, seed, chunk_sizes[seed % CHUNK_SIZE_COUNT]);
+    renoise_stats_enable(true);
+    Renoise_Stats before = renoise_stats_snapshot();
+    renoise_world_generate_chunk_points(world, 1, 2);
+    Renoise_Stats after = renoise_stats_snapshot();
+    assert(after.samples_evaluated - before.samples_evaluated == (uint64_t) (world->chunk_size*world->chunk_size));
+    assert(after.calls[RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS] - before.calls[RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS] == 1);
+
+    // Turned off, nothing gets counted
+    renoise_stats_enable(false);
+    renoise_world_generate_chunk_points(world, 2, 1);
+    Renoise_Stats disabled = renoise_stats_snapshot();
+    assert(disabled.samples_evaluated == after.samples_evaluated);
+    assert(disabled.calls[RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS] == after.calls[RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS]);
+    renoise_world_free(world);
+}
+
+// FNV-1a over the bytes of the samples, lowest byte first, so the hash is the same on every platform
+static uint64_t hash_int16(const int16_t* samples, int64_t count) {
+    uint64_t hash = 0xCBF29CE484222325;
+    for (int64_t i = 0; i < count; ++i) {
+        uint16_t sample = (uint16_t) samples[i];
+        hash = (hash ^ (sample & 0xFF)) * 0x100000001B3;
+        hash = (hash ^ (sample >> 8)) * 0x100000001B3;
+    }
+    return hash;
+}
+
+// The fixed-point kernel promises the same bits everywhere, so its output is pinned down exactly rather than within
+// a tolerance: any change to the lattice, the gradient table or the rounding shows up here
+static const struct {
+    uint64_t seed;
+    uint32_t frequency_q16;
+    int64_t chunk_size;
+    int64_t chunk_x;
+    int64_t chunk_y;
+    uint64_t hash;
+} fixed_golden[] = {
+    { 1234, 0x3333, 16, 1, 1, 0xE43E9A670E814081 },
+    { 1234, 0x8000, 32, 2, 1, 0xEAB3A4C8F8423582 },
+    { 99,   0x1000, 64, 1, 2, 0x14B6A6C77DD295FF },
+};
+
+static void check_fixed_golden() {
+    for (size_t i = 0; i < sizeof(fixed_golden)/sizeof(fixed_golden[0]); ++i) {
+        Renoise_World* world = renoise_world_generate_fixed(4, fixed_golden[i].frequency_q16, fixed_golden[i].seed, fixed_golden[i].chunk_size);
+        int16_t* points = malloc(world->chunk_size*world->chunk_size * sizeof(int16_t));
+        renoise_world_generate_chunk_points_fixed(world, fixed_golden[i].chunk_x, fixed_golden[i].chunk_y, points, world->chunk_size);
+        uint64_t hash = hash_int16(points, world->chunk_size*world->chunk_size);
+        printf("{\"check\": \"fixed_golden\", \"chunk_size\": %"PRIi64", \"hash\": \"%016"PRIx64"\", \"pass\": %s}\n",
+            world->chunk_size, hash, hash == fixed_golden[i].hash ? "true" : "false");
+        assert(hash == fixed_golden[i].hash && "ERROR: The fixed-point kernel's output changed");
+        free(points);
+        renoise_world_free(world);
+    }
+}
+
+// The floating-point kernels against golden hashes of their output, quantized to 16 bits so that a last-bit
+// difference in the platform's libm doesn't matter. The references above follow the library's formulas, so this is
+// what catches a change to a formula itself: the simplex scale, the triangle split or the value noise's lattice.
+static const struct {
+    Renoise_Noise noise;
+    uint64_t seed;
+    double frequency;
+    int64_t chunk_size;
+    int64_t chunk_x;
+    int64_t chunk_y;
+    uint64_t hash;
+} noise_golden[] = {
+    { RENOISE_NOISE_PERLIN,  1234, 0.2,  16, 1, 1, 0x852A3FE7ED101625 },
+    { RENOISE_NOISE_SIMPLEX, 1234, 0.2,  16, 1, 1, 0x0F87A88B76C2FA29 },
+    { RENOISE_NOISE_VALUE,   1234, 0.2,  16, 1, 1, 0x2C5FC1C926D18F86 },
+    { RENOISE_NOISE_SIMPLEX, 99,   0.25, 32, 2, 1, 0xB0AB28528B0B5EB9 },
+    { RENOISE_NOISE_VALUE,   99,   0.25, 32, 2, 1, 0xA34AA9D99DA18981 },
+};
+
+static void check_noise_golden() {
+    for (size_t i = 0; i < sizeof(noise_golden)/sizeof(noise_golden[0]); ++i) {
+        Renoise_World* world = renoise_world_generate_sized(4, noise_golden[i].frequency, noise_golden[i].seed, noise_golden[i].chunk_size);
+        renoise_world_set_noise(world, noise_golden[i].noise);
+        int16_t* points = malloc(world->chunk_size*world->chunk_size * sizeof(int16_t));
+        renoise_world_generate_chunk_points_quantized(world, noise_golden[i].chunk_x, noise_golden[i].chunk_y, renoise_quantize_default(RENOISE_QUANTIZE_INT16), points, world->chunk_size);
+        uint64_t hash = hash_int16(points, world->chunk_size*world->chunk_size);
+        printf("{\"check\": \"noise_golden\", \"noise\": %d, \"chunk_size\": %"PRIi64", \"hash\": \"%016"PRIx64"\", \"pass\": %s}\n",
+            (int) noise_golden[i].noise, world->chunk_size, hash, hash == noise_golden[i].hash ? "true" : "false");
+        assert(hash == noise_golden[i].hash && "ERROR: The noise changed");
+        free(points);
+        renoise_world_free(world);
+    }
+}
+
+static void compare(Kernel* kernel, const double* reference, const double* plane, int64_t world_size) {
+    int64_t stride = world_size * chunk_size;
+    for (int64_t y = chunk_size; y < stride - chunk_size; ++y) {
+        for (int64_t x = chunk_size; x < stride - chunk_size; ++x) {
+            double error = fabs(plane[y*stride + x] - reference[y*stride + x]);
+            if (error > kernel->max_error) kernel->max_error = error;
+
+            // Seams: the step over a chunk border, compared to the step in the reference
+            if (x % chunk_size == chunk_size - 1 && x + 1 < stride - chunk_size) {
+                double step = plane[y*stride + x + 1] - plane[y*stride + x];
+                double reference_step = reference[y*stride + x + 1] - reference[y*stride + x];
+                double seam_error = fabs(step - reference_step);
+                if (seam_error > kernel->max_seam_error) kernel->max_seam_error = seam_error;
+            }
+            if (y % chunk_size == chunk_size - 1 && y + 1 < stride - chunk_size) {
+                double step = plane[(y + 1)*stride + x] - plane[y*stride + x];
+                double reference_step = reference[(y + 1)*stride + x] - reference[y*stride + x];
+                double seam_error = fabs(step - reference_step);
+                if (seam_error > kernel->max_seam_error) kernel->max_seam_error = seam_error;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int64_t trials = argc > 1 ? strtoll(argv[1], NULL, 10) : 50;
+    rng_state = argc > 2 ? strtoull(argv[2], NULL, 0) : 0x5EED;
+    if (rng_state == 0) rng_state = 1;
+
+    // Sanity check of the reference itself: the biggest step over a chunk border shouldn't be much bigger than
+    // the biggest step inside a chunk
+    double max_border_step = 0.0;
+    double max_inner_step = 0.0;
+
+    for (int64_t trial = 0; trial < trials; ++trial) {
+        uint64_t seed = rng_next();
+        int64_t world_size = rng_range(3, 8);
+        chunk_size = chunk_sizes[rng_next() % CHUNK_SIZE_COUNT];
+        // Between the lowest supported frequency and one gradient point per sample
+        double frequency = (double) rng_range(chunk_size, 8*chunk_size) / (8.0*chunk_size);
+        // Every other trial on average is on a fixed-point world, on the nearest fixed-point frequency
+        frequency_q16 = rng_next() % 2 == 0 ? (uint32_t) round(frequency * 65536.0) : 0;
+        // Half of the trials on Perlin noise, the rest split between simplex and value noise
+        uint64_t noise_roll = rng_next() % 4;
+        noise = noise_roll < 2 ? RENOISE_NOISE_PERLIN : noise_roll == 2 ? RENOISE_NOISE_SIMPLEX : RENOISE_NOISE_VALUE;
+        // A third of the trials warped, by up to two chunks so the warp reaches past the neighbouring chunks
+        warp = (Renoise_Warp) {0};
+        if (rng_next() % 3 == 0) {
+            warp.amplitude = rng_range(1, 16*chunk_size) / 8.0;
+            warp.frequency = rng_range(1, 16) / (8.0*chunk_size);
+            warp.seed = rng_next();
+        }
+        int64_t operation_count = rng_range(0, MAX_OPERATIONS);
+
+        int64_t stride = world_size * chunk_size;
+        double* reference = calloc(stride * stride, sizeof(double));
+        double* plane = calloc(stride * stride, sizeof(double));
+        assert(reference != NULL && plane != NULL);
+
+        for (size_t k = 0; k < KERNEL_COUNT; ++k) {
+            // Every kernel gets a fresh world with the same history, kernels may change how the world is stored
+            Renoise_World* world = generate_world(world_size, frequency, seed);
+            world->journal = renoise_journal_create();
+            uint64_t sequence_state = rng_state;
+            for (int64_t i = 0; i < operation_count; ++i) {
+                int64_t x = rng_range(0, world_size - 1);
+                int64_t y = rng_range(0, world_size - 1);
+                if (rng_next() % 2 == 0) {
+                    renoise_world_regenerate_full_chunk(world, x, y);
+                } else {
+                    renoise_world_regenerate_rect(world, x, y, rng_range(1, world_size - x), rng_range(1, world_size - y));
+                }
+            }
+            if (k < KERNEL_COUNT - 1) rng_state = sequence_state;
+
+            if (k == 0) {
+                FOR_INNER_CHUNKS(world) reference_chunk_points(world, chunk_x, chunk_y, reference, stride);
+                for (int64_t y = chunk_size; y < stride - chunk_size; ++y) {
+                    for (int64_t x = chunk_size; x < stride - chunk_size - 1; ++x) {
+                        double step = fabs(reference[y*stride + x + 1] - reference[y*stride + x]);
+                        if (x % chunk_size == chunk_size - 1) {
+                            if (step > max_border_step) max_border_step = step;
+                        } else {
+                            if (step > max_inner_step) max_inner_step = step;
+                        }
+                    }
+                }
+            }
+
+            bool applies = false;
+            switch (kernels[k].worlds) {
+            case WORLDS_ALL:          applies = true; break;
+            case WORLDS_DOUBLE:       applies = frequency_q16 == 0; break;
+            case WORLDS_FIXED_PERLIN: applies = frequency_q16 != 0 && noise == RENOISE_NOISE_PERLIN && warp.amplitude == 0.0; break;
+            }
+            if (applies) {
+                memset(plane, 0, stride * stride * sizeof(double));
+                if (kernels[k].function != NULL) {
+                    kernels[k].function(world, plane, stride);
+                } else {
+                    kernel_replay(&kernels[k].replay, world, plane, stride);
+                }
+                compare(&kernels[k], reference, plane, world_size);
+                kernels[k].trials += 1;
+            }
+
+            renoise_journal_free(world->journal);
+            renoise_world_free(world);
+        }
+
+        free(reference);
+        free(plane);
+    }
+
+    for (int64_t trial = 0; trial < trials; ++trial) check_change_feed(rng_next());
+    check_visibility();
+    check_visibility_regeneration();
+    check_fixed_golden();
+    check_noise_golden();
+    for (int64_t trial = 0; trial < (trials + 9) / 10; ++trial) {
+        const Renoise_Noise derivative_noises[] = { RENOISE_NOISE_PERLIN, RENOISE_NOISE_SIMPLEX, RENOISE_NOISE_VALUE };
+        check_derivatives(rng_next(), derivative_noises[trial % 3], false);
+        check_derivatives(rng_next(), RENOISE_NOISE_SIMPLEX, true);
+    }
+    for (size_t trial = 0; trial < CHUNK_SIZE_COUNT; ++trial) check_stats(trial);
+
+    // The 3D kernel is checked on its own, its worlds are too big to test with every trial
+    double kernel3_max_error = 0.0;
+    double kernel3_max_seam_error = 0.0;
+    for (int64_t trial = 0; trial < (trials + 9) / 10; ++trial) {
+        double frequency = (double) rng_range(RENOISE_CHUNK_SIZE, 4*RENOISE_CHUNK_SIZE) / (8.0*RENOISE_CHUNK_SIZE);
+        check_kernel3(rng_next(), frequency, &kernel3_max_error, &kernel3_max_seam_error);
+    }
+    // Float points: half an ulp at 1.0 per sample, twice that for a step
+    double kernel3_tolerance = 0x1.0p-24;
+
+    bool pass = kernel3_max_error <= kernel3_tolerance && kernel3_max_seam_error <= 2*kernel3_tolerance;
+    printf(
+        "{\"kernel\": \"world3_trilinear\", \"chunk_size\": %d, \"trials\": %"PRIi64", \"max_error\": %g, \"max_seam_error\": %g, "
+        "\"tolerance\": %g, \"pass\": %s}\n",
+        RENOISE_CHUNK_SIZE, (trials + 9) / 10, kernel3_max_error, kernel3_max_seam_error, kernel3_tolerance, pass ? "true" : "false"
+    );
+    for (size_t k = 0; k < KERNEL_COUNT; ++k) {
+        Kernel* kernel = &kernels[k];
+        bool kernel_pass = kernel->max_error <= kernel->tolerance && kernel->max_seam_error <= 2*kernel->tolerance;
+        pass = pass && kernel_pass;
+        printf(
+            "{\"kernel\": \"%s\", \"chunk_sizes\": [%"PRIi64", %"PRIi64", %"PRIi64", %"PRIi64"], \"trials\": %"PRIi64", \"max_error\": %g, \"max_seam_error\": %g, "
+            "\"tolerance\": %g, \"pass\": %s}\n",
+            kernel->name, chunk_sizes[0], chunk_sizes[1], chunk_sizes[2], chunk_sizes[3], kernel->trials, kernel->max_error, kernel->max_seam_error, kernel->tolerance, kernel_pass ? "true" : "false"
+        );
+    }
+    bool derivatives_pass = max_derivative_error <= DERIVATIVE_TOLERANCE;
+    pass = pass && derivatives_pass;
+    printf(
+        "{\"check\": \"derivatives_centred\", \"max_error\": %g, \"tolerance\": %g, \"pass\": %s}\n",
+        max_derivative_error, DERIVATIVE_TOLERANCE, derivatives_pass ? "true" : "false"
+    );
+    printf(
+        "{\"reference\": \"seams\", \"chunk_sizes\": [%"PRIi64", %"PRIi64", %"PRIi64", %"PRIi64"], \"max_border_step\": %g, \"max_inner_step\": %g}\n",
+        chunk_sizes[0], chunk_sizes[1], chunk_sizes[2], chunk_sizes[3], max_border_step, max_inner_step
+    );
+
+    return pass ? 0 : 1;
+}
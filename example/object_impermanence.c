@@ -7,6 +7,7 @@
 #include <raymath.h>
 #include <renoise.h>
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 
 int main(void) {
@@ -17,53 +18,70 @@ int main(void) {
     #define FOV 90.0
 
     // Initialize window
-    const int window_size = world->size * RENOISE_CHUNK_SIZE * SCALE;
+    const int window_size = world->size * world->chunk_size * SCALE;
     SetConfigFlags(FLAG_MSAA_4X_HINT);
     InitWindow(window_size, window_size, "Renoise Example: Object Impermanence");
     SetTargetFPS(60);
 
+    // The noise is rasterized into one texture, which gets drawn scaled up. After the first time,
+    // only the chunks the change feed reports get rasterized again.
+    const int world_pixels = world->size * world->chunk_size;
+    uint8_t* pixels = malloc(world_pixels * world_pixels * 4);
+    Image image = {
+        .data = pixels,
+        .width = world_pixels,
+        .height = world_pixels,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+    renoise_world_rasterize(world, (Renoise_Rect) { 0, 0, world_pixels, world_pixels }, pixels, world_pixels * 4, NULL);
+    Texture2D texture = LoadTextureFromImage(image);
+    Renoise_Chunk_Change changes[64];
+    while (renoise_world_drain_changes(world, changes, 64) > 0);
+
     // Initialize some needed variables
     Renoise_Vector player_world_pos = {
-        RENOISE_CHUNK_SIZE * (VIEW_DISTANCE + 1),
-        RENOISE_CHUNK_SIZE * (VIEW_DISTANCE + 1),
+        world->chunk_size * (VIEW_DISTANCE + 1),
+        world->chunk_size * (VIEW_DISTANCE + 1),
     };
     Vector2 player_pos = (Vector2) { player_world_pos.x * SCALE, player_world_pos.y * SCALE };
     double player_angle = -45.0;
-    bool seen_chunks[world->size][world->size];
-    memset(seen_chunks, 0, sizeof(seen_chunks));
+    // Chunks get regenerated as soon as they leave the view
+    Renoise_Visibility* visibility = renoise_visibility_create(world);
+    visibility->regenerate_hidden = true;
 
     while (!WindowShouldClose()) {
         BeginDrawing();
             ClearBackground(BLACK);
             // Draw the noise
-            for (int64_t wy = 0; wy < world->size; ++wy) {
-                for (int64_t wx = 0; wx < world->size; ++wx) {
-                    int64_t windex = wx + wy*world->size;
-                    Renoise_Chunk* chunk = world->chunks[windex];
-                    double off_x = wx * RENOISE_CHUNK_SIZE * SCALE;
-                    double off_y = wy * RENOISE_CHUNK_SIZE * SCALE;
-                    for (uint8_t chunk_x = 0; chunk_x < RENOISE_CHUNK_SIZE; ++chunk_x) {
-                        for (uint8_t chunk_y = 0; chunk_y < RENOISE_CHUNK_SIZE; ++chunk_y) {
-                            uint8_t gray_val = (chunk->points[chunk_y][chunk_x] + 1.0) / 2.0 * 255;
-                            DrawRectangle(
-                                off_x + chunk_x * SCALE,
-                                off_y + chunk_y * SCALE,
-                                SCALE,
-                                SCALE,
-                                (Color) { gray_val, gray_val, gray_val, 255 }
-                            );
-                        }
-                    }
-                    if (seen_chunks[wy][wx]) {
-                        DrawRectangle(
-                            off_x,
-                            off_y,
-                            RENOISE_CHUNK_SIZE * SCALE,
-                            RENOISE_CHUNK_SIZE * SCALE,
-                            (Color) { 0, 228, 48, 63 }
-                        );
-                    }
+            int64_t change_count = 0;
+            bool changed = false;
+            while ((change_count = renoise_world_drain_changes(world, changes, 64)) > 0) {
+                for (int64_t i = 0; i < change_count; ++i) {
+                    int64_t pixel_x = changes[i].chunk_x * world->chunk_size;
+                    int64_t pixel_y = changes[i].chunk_y * world->chunk_size;
+                    renoise_world_rasterize(
+                        world,
+                        (Renoise_Rect) { pixel_x, pixel_y, world->chunk_size, world->chunk_size },
+                        pixels + (pixel_x + pixel_y * world_pixels) * 4,
+                        world_pixels * 4,
+                        NULL
+                    );
                 }
+                changed = true;
+            }
+            if (changed) UpdateTexture(texture, pixels);
+            DrawTextureEx(texture, (Vector2) { 0, 0 }, 0.0, SCALE, WHITE);
+            for (int64_t i = 0; i < visibility->visible.count; ++i) {
+                int64_t wx = visibility->visible.items[i] % world->size;
+                int64_t wy = visibility->visible.items[i] / world->size;
+                DrawRectangle(
+                    wx * world->chunk_size * SCALE,
+                    wy * world->chunk_size * SCALE,
+                    world->chunk_size * SCALE,
+                    world->chunk_size * SCALE,
+                    (Color) { 0, 228, 48, 63 }
+                );
             }
 
 
@@ -75,46 +93,21 @@ int main(void) {
                 player_angle = player_angle_rad / M_PI * 180.0;
             }
 
-            // Calculate frustum bounding box (for chunk collision)
-            Renoise_Vector frustum_points[3];
-            frustum_points[0] = player_world_pos;
-            frustum_points[1] = (Renoise_Vector) {
-                player_world_pos.x + cos(player_angle_rad - fov_rad/2.0) * VIEW_DISTANCE * RENOISE_CHUNK_SIZE,
-                player_world_pos.y + sin(player_angle_rad - fov_rad/2.0) * VIEW_DISTANCE * RENOISE_CHUNK_SIZE,
+            // The view frustum, a triangle in 2D
+            Renoise_View view = { .kind = RENOISE_VIEW_TRIANGLE };
+            view.points[0] = player_world_pos;
+            view.points[1] = (Renoise_Vector) {
+                player_world_pos.x + cos(player_angle_rad - fov_rad/2.0) * VIEW_DISTANCE * world->chunk_size,
+                player_world_pos.y + sin(player_angle_rad - fov_rad/2.0) * VIEW_DISTANCE * world->chunk_size,
             };
-            frustum_points[2] = (Renoise_Vector) {
-                player_world_pos.x + cos(player_angle_rad + fov_rad/2.0) * VIEW_DISTANCE * RENOISE_CHUNK_SIZE,
-                player_world_pos.y + sin(player_angle_rad + fov_rad/2.0) * VIEW_DISTANCE * RENOISE_CHUNK_SIZE,
+            view.points[2] = (Renoise_Vector) {
+                player_world_pos.x + cos(player_angle_rad + fov_rad/2.0) * VIEW_DISTANCE * world->chunk_size,
+                player_world_pos.y + sin(player_angle_rad + fov_rad/2.0) * VIEW_DISTANCE * world->chunk_size,
             };
-            Renoise_Vector frustum_point_min = {  INFINITY,  INFINITY };
-            Renoise_Vector frustum_point_max = { -INFINITY, -INFINITY };
-            for (int8_t i = 0; i < 3; ++i) {
-                if (frustum_points[i].x < frustum_point_min.x)
-                    frustum_point_min.x = frustum_points[i].x;
-                if (frustum_points[i].y < frustum_point_min.y)
-                    frustum_point_min.y = frustum_points[i].y;
-                if (frustum_points[i].x > frustum_point_max.x)
-                    frustum_point_max.x = frustum_points[i].x;
-                if (frustum_points[i].y > frustum_point_max.y)
-                    frustum_point_max.y = frustum_points[i].y;
-            }
+            Renoise_Vector* frustum_points = view.points;
 
-            // Mark chunks as "seen"
-            for (int64_t chunk_index = 0; chunk_index < world->size*world->size; ++chunk_index) {
-                Renoise_Chunk* chunk = world->chunks[chunk_index];
-                // Use buffer so you can't see chunks changing (fully regenerating a chunk affects surrounding chunks)
-                // static double buffer = RENOISE_CHUNK_SIZE/2;
-                static double buffer = 0;
-                if (
-                    (chunk->x+1) * RENOISE_CHUNK_SIZE + buffer > frustum_point_min.x && (chunk->y+1) * RENOISE_CHUNK_SIZE + buffer > frustum_point_min.y &&
-                    (chunk->x)   * RENOISE_CHUNK_SIZE - buffer < frustum_point_max.x && (chunk->y)   * RENOISE_CHUNK_SIZE - buffer < frustum_point_max.y
-                ) {
-                    seen_chunks[chunk->y][chunk->x] = true;
-                } else if (seen_chunks[chunk->y][chunk->x]) {
-                    seen_chunks[chunk->y][chunk->x] = false;
-                    renoise_world_regenerate_full_chunk(world, chunk->x, chunk->y);
-                }
-            }
+            // Mark chunks as "seen", and regenerate the ones that aren't anymore
+            renoise_visibility_update(visibility, &view, 1);
 
 
             // Draw the "player"
@@ -135,17 +128,6 @@ int main(void) {
                 SCALE, ORANGE
             );
 
-            // Draw frustum bounding box
-            DrawRectangleLinesEx(
-                (Rectangle) {
-                    frustum_point_min.x * SCALE,
-                    frustum_point_min.y * SCALE,
-                    (frustum_point_max.x - frustum_point_min.x) * SCALE,
-                    (frustum_point_max.y - frustum_point_min.y) * SCALE,
-                },
-                SCALE/2.0, RED
-            );
-
             DrawFPS(10, 10);
         EndDrawing();
     }
@@ -6,6 +6,7 @@
 #include <raylib.h>
 #include <renoise.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <inttypes.h>
 
@@ -19,10 +20,26 @@ int main() {
     }
 
     #define SCALE 8
-    const int window_size = world->size * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE * 2;
+    const int window_size = world->size * world->chunk_size * SCALE + 1/world->frequency * SCALE * 2;
     InitWindow(window_size, window_size, "Renoise Example: Simple Demo");
     SetTargetFPS(60);
 
+    // The noise is rasterized into one texture, which gets drawn scaled up. After the first time,
+    // only the chunks the change feed reports get rasterized again.
+    const int world_pixels = world->size * world->chunk_size;
+    uint8_t* pixels = malloc(world_pixels * world_pixels * 4);
+    Image image = {
+        .data = pixels,
+        .width = world_pixels,
+        .height = world_pixels,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+    renoise_world_rasterize(world, (Renoise_Rect) { 0, 0, world_pixels, world_pixels }, pixels, world_pixels * 4, NULL);
+    Texture2D texture = LoadTextureFromImage(image);
+    Renoise_Chunk_Change changes[64];
+    while (renoise_world_drain_changes(world, changes, 64) > 0);
+
     // Visual control booleans
     bool background = false;
     bool text = false;
@@ -59,32 +76,38 @@ int main() {
             if (IsKeyPressed(KEY_H)) {
                 enable_tutorial = !enable_tutorial;
             }
+            int64_t change_count = 0;
+            bool changed = false;
+            while ((change_count = renoise_world_drain_changes(world, changes, 64)) > 0) {
+                for (int64_t i = 0; i < change_count; ++i) {
+                    int64_t pixel_x = changes[i].chunk_x * world->chunk_size;
+                    int64_t pixel_y = changes[i].chunk_y * world->chunk_size;
+                    renoise_world_rasterize(
+                        world,
+                        (Renoise_Rect) { pixel_x, pixel_y, world->chunk_size, world->chunk_size },
+                        pixels + (pixel_x + pixel_y * world_pixels) * 4,
+                        world_pixels * 4,
+                        NULL
+                    );
+                }
+                changed = true;
+            }
+            if (changed) UpdateTexture(texture, pixels);
+            DrawTextureEx(texture, (Vector2) { 1/world->frequency * SCALE, 1/world->frequency * SCALE }, 0.0, SCALE, WHITE);
+
             double y = 0;
             for (int64_t wy = 0; wy < world->size; ++wy) {
                 double x = 0;
                 Renoise_Chunk* chunk = NULL;
                 for (int64_t wx = 0; wx < world->size; ++wx) {
-                    int64_t windex = wx + wy*world->size;
-                    chunk = world->chunks[windex];
-                    double off_x = wx * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE;
-                    double off_y = wy * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE;
-                    for (uint8_t chunk_x = 0; chunk_x < RENOISE_CHUNK_SIZE; ++chunk_x) {
-                        for (uint8_t chunk_y = 0; chunk_y < RENOISE_CHUNK_SIZE; ++chunk_y) {
-                            uint8_t gray_val = (chunk->points[chunk_y][chunk_x] + 1.0) / 2.0 * 255;
-                            DrawRectangle(
-                                off_x + chunk_x * SCALE,
-                                off_y + chunk_y * SCALE,
-                                SCALE,
-                                SCALE,
-                                (Color) { gray_val, gray_val, gray_val, 255 }
-                            );
-                        }
-                    }
+                    chunk = renoise_world_get_chunk(world, wx, wy);
+                    double off_x = wx * world->chunk_size * SCALE + 1/world->frequency * SCALE;
+                    double off_y = wy * world->chunk_size * SCALE + 1/world->frequency * SCALE;
                     if (background) DrawRectangle(
                         off_x,
                         off_y,
-                        RENOISE_CHUNK_SIZE * SCALE,
-                        RENOISE_CHUNK_SIZE * SCALE,
+                        world->chunk_size * SCALE,
+                        world->chunk_size * SCALE,
                         (Color) { 0, ((double) wx / (double) world->size) * 255, ((double) wy / (double) world->size) * 255, 127 }
                     );
                     for (int64_t ci = 0; ci < chunk->grad_point_count_x*chunk->grad_point_count_y; ++ci) {
@@ -121,8 +144,8 @@ int main() {
                 y += chunk->grad_point_count_y;
             }
 
-            int64_t mouse_chunk_x = (GetMouseX() - 1/world->frequency * SCALE) / RENOISE_CHUNK_SIZE / SCALE;
-            int64_t mouse_chunk_y = (GetMouseY() - 1/world->frequency * SCALE) / RENOISE_CHUNK_SIZE / SCALE;
+            int64_t mouse_chunk_x = (GetMouseX() - 1/world->frequency * SCALE) / world->chunk_size / SCALE;
+            int64_t mouse_chunk_y = (GetMouseY() - 1/world->frequency * SCALE) / world->chunk_size / SCALE;
             if (mouse_chunk_x < 0 || mouse_chunk_x >= world->size
              || mouse_chunk_y < 0 || mouse_chunk_y >= world->size) goto end_select;
             if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
@@ -136,18 +159,18 @@ int main() {
             } else if (!IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
                 DrawRectangleLinesEx(
                     (Rectangle) {
-                        mouse_chunk_x * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
-                        mouse_chunk_y * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
-                        RENOISE_CHUNK_SIZE * SCALE,
-                        RENOISE_CHUNK_SIZE * SCALE,
+                        mouse_chunk_x * world->chunk_size * SCALE + 1/world->frequency * SCALE,
+                        mouse_chunk_y * world->chunk_size * SCALE + 1/world->frequency * SCALE,
+                        world->chunk_size * SCALE,
+                        world->chunk_size * SCALE,
                     },
                     SCALE/2.0,
                     RED
                 );
                 DrawText(
                     TextFormat("(%"PRIi64", %"PRIi64")", mouse_chunk_x, mouse_chunk_y),
-                    mouse_chunk_x * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
-                    mouse_chunk_y * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
+                    mouse_chunk_x * world->chunk_size * SCALE + 1/world->frequency * SCALE,
+                    mouse_chunk_y * world->chunk_size * SCALE + 1/world->frequency * SCALE,
                     24,
                     YELLOW
                 );
@@ -164,18 +187,18 @@ int main() {
             if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
                 DrawRectangleLinesEx(
                     (Rectangle) {
-                        mouse_chunk_x_start * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
-                        mouse_chunk_y_start * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
-                        (mouse_chunk_x - mouse_chunk_x_start + 1) * RENOISE_CHUNK_SIZE * SCALE,
-                        (mouse_chunk_y - mouse_chunk_y_start + 1) * RENOISE_CHUNK_SIZE * SCALE,
+                        mouse_chunk_x_start * world->chunk_size * SCALE + 1/world->frequency * SCALE,
+                        mouse_chunk_y_start * world->chunk_size * SCALE + 1/world->frequency * SCALE,
+                        (mouse_chunk_x - mouse_chunk_x_start + 1) * world->chunk_size * SCALE,
+                        (mouse_chunk_y - mouse_chunk_y_start + 1) * world->chunk_size * SCALE,
                     },
                     SCALE/2.0,
                     RED
                 );
                 DrawText(
                     TextFormat("(%"PRIi64", %"PRIi64", %"PRIi64", %"PRIi64")", mouse_chunk_x_start, mouse_chunk_y_start, mouse_chunk_x - mouse_chunk_x_start + 1, mouse_chunk_y - mouse_chunk_y_start + 1),
-                    mouse_chunk_x_start * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
-                    mouse_chunk_y_start * RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE,
+                    mouse_chunk_x_start * world->chunk_size * SCALE + 1/world->frequency * SCALE,
+                    mouse_chunk_y_start * world->chunk_size * SCALE + 1/world->frequency * SCALE,
                     24,
                     YELLOW
                 );
@@ -184,12 +207,14 @@ int main() {
             DrawFPS(10, 10);
 
             if (enable_tutorial) {
-                DrawRectangle(1/world->frequency * SCALE, RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE, MeasureText(tutorial_text, tutorial_font_size) + SCALE*4, (tutorial_font_size+2)*tutorial_lines + SCALE*2, BLACK);
-                DrawText(tutorial_text, 1/world->frequency * SCALE + SCALE*2, RENOISE_CHUNK_SIZE * SCALE + 1/world->frequency * SCALE + SCALE, tutorial_font_size, YELLOW);
+                DrawRectangle(1/world->frequency * SCALE, world->chunk_size * SCALE + 1/world->frequency * SCALE, MeasureText(tutorial_text, tutorial_font_size) + SCALE*4, (tutorial_font_size+2)*tutorial_lines + SCALE*2, BLACK);
+                DrawText(tutorial_text, 1/world->frequency * SCALE + SCALE*2, world->chunk_size * SCALE + 1/world->frequency * SCALE + SCALE, tutorial_font_size, YELLOW);
             }
         EndDrawing();
     }
 
+    UnloadTexture(texture);
+    free(pixels);
     renoise_world_free(world);
 
     CloseWindow();
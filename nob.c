@@ -4,13 +4,26 @@
 
 #define CMD_CC(cmd) cmd_append(cmd, "gcc")
 #define CMD_CC_WIN(cmd) cmd_append(cmd, "x86_64-w64-mingw32-gcc", "-static")
-#define CMD_CFLAGS(cmd) cmd_append(cmd, "-Wall", "-Wextra", "-Wswitch-enum", "-ggdb")
+#define CMD_CFLAGS(cmd) do { cmd_append(cmd, "-Wall", "-Wextra", "-Wswitch-enum", "-ggdb"); if (USE_OPENMP) cmd_append(cmd, "-fopenmp"); } while (0)
 #define CMD_LFLAGS(cmd) cmd_append(cmd, "-lm")
 
 #define COMPILE_WIN true
+// Lets renoise_world_rasterize and the region reads use multiple threads. Off by default: with it on, whatever links
+// ./build/lib/renoise.a has to link with -fopenmp too.
+#define USE_OPENMP false
 
 static const char* renoise_cfiles[] = {
     "renoise",
+    "renoise_store",
+    "renoise_journal",
+    "renoise_stats",
+    "renoise3",
+    "renoise_raster",
+    "renoise_changes",
+    "renoise_fixed",
+    "renoise_regeneration",
+    "renoise_snapshot",
+    "renoise_visibility",
 };
 
 bool build_renoise() {
@@ -37,6 +50,7 @@ bool build_renoise() {
         const char* depends[] = {
             input_path,
             "./src/renoise.h",
+            "./src/renoise_internal.h",
         };
 
         if (needs_rebuild(output_path, depends, ARRAY_LEN(depends))) {
@@ -70,15 +84,15 @@ bool build_renoise() {
     const char* lib_path = "./build/lib/renoise.a";
     if (needs_rebuild(lib_path, object_files.items, object_files.count)) {
         cmd_append(&cmd, "ar", "-crs", lib_path);
-        cmd_append(&cmd, "./build/renoise/renoise.o");
+        da_append_many(&cmd, object_files.items, object_files.count);
         if (!cmd_run_sync_and_reset(&cmd)) return_defer(false);
     }
 
     if (COMPILE_WIN) {
         const char* lib_path = "./build/lib/windows/renoise.a";
-        if (needs_rebuild(lib_path, object_files.items, object_files.count)) {
+        if (needs_rebuild(lib_path, object_files_win.items, object_files_win.count)) {
             cmd_append(&cmd, "ar", "-crs", lib_path);
-            cmd_append(&cmd, "./build/renoise/windows/renoise.o");
+            da_append_many(&cmd, object_files_win.items, object_files_win.count);
             if (!cmd_run_sync_and_reset(&cmd)) return_defer(false);
         }
     }
@@ -91,10 +105,67 @@ bool build_renoise() {
 defer:
     cmd_free(cmd);
     da_free(object_files);
+    da_free(object_files_win);
     da_free(procs);
     return result;
 }
 
+bool build_and_run_bench() {
+    bool result = true;
+    Cmd cmd = {0};
+
+    if (!mkdir_if_not_exists("./build/bench")) return_defer(false);
+
+    CMD_CC(&cmd);
+    CMD_CFLAGS(&cmd);
+    // Benchmark the optimised library, so the sources get compiled in instead of linking ./build/lib/renoise.a
+    cmd_append(&cmd, "-O2", "-DNDEBUG");
+    cmd_append(&cmd, "-I./src");
+    cmd_append(&cmd, "-o", "./build/bench/bench");
+    cmd_append(&cmd, "./bench/bench.c");
+    for (size_t j = 0; j < ARRAY_LEN(renoise_cfiles); ++j) {
+        cmd_append(&cmd, temp_sprintf("./src/%s.c", renoise_cfiles[j]));
+    }
+    CMD_LFLAGS(&cmd);
+    if (!cmd_run_sync_and_reset(&cmd)) return_defer(false);
+
+    // The benchmark goes over the chunk sizes itself
+    cmd_append(&cmd, "./build/bench/bench");
+    if (!cmd_run_sync_and_reset(&cmd)) return_defer(false);
+
+defer:
+    cmd_free(cmd);
+    return result;
+}
+
+bool build_and_run_difftest(int argc, char** argv) {
+    bool result = true;
+    Cmd cmd = {0};
+
+    if (!mkdir_if_not_exists("./build/bench")) return_defer(false);
+
+    CMD_CC(&cmd);
+    CMD_CFLAGS(&cmd);
+    // Optimised like the benchmarks, but with the assertions left in
+    cmd_append(&cmd, "-O2");
+    cmd_append(&cmd, "-I./src");
+    cmd_append(&cmd, "-o", "./build/bench/difftest");
+    cmd_append(&cmd, "./bench/difftest.c");
+    for (size_t j = 0; j < ARRAY_LEN(renoise_cfiles); ++j) {
+        cmd_append(&cmd, temp_sprintf("./src/%s.c", renoise_cfiles[j]));
+    }
+    CMD_LFLAGS(&cmd);
+    if (!cmd_run_sync_and_reset(&cmd)) return_defer(false);
+
+    cmd_append(&cmd, "./build/bench/difftest");
+    da_append_many(&cmd, argv, argc);
+    if (!cmd_run_sync_and_reset(&cmd)) return_defer(false);
+
+defer:
+    cmd_free(cmd);
+    return result;
+}
+
 void log_usage(Log_Level level, const char* program) {
     nob_log(level, "Usage: %s COMMAND", program);
 }
@@ -103,6 +174,8 @@ void log_commands(Log_Level level) {
     nob_log(level, "Available commands:");
     nob_log(level, "  build     Build only the library");
     nob_log(level, "  example   Build the example program");
+    nob_log(level, "  bench     Build and run the benchmarks, results are printed to stdout as JSON lines");
+    nob_log(level, "  difftest  Build and run the differential tester: difftest [trials] [seed]");
 }
 
 static const char* examples[] = {
@@ -129,6 +202,12 @@ int main(int argc, char** argv) {
         compile_example = true;
     } else if (strcmp(command, "build") == 0) {
         compile_example = false;
+    } else if (strcmp(command, "bench") == 0) {
+        if (!mkdir_if_not_exists("./build")) return 1;
+        return build_and_run_bench() ? 0 : 1;
+    } else if (strcmp(command, "difftest") == 0) {
+        if (!mkdir_if_not_exists("./build")) return 1;
+        return build_and_run_difftest(argc, argv) ? 0 : 1;
     } else {
         log_usage(ERROR, program);
         nob_log(ERROR, "Unknown command %s", command);
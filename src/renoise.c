@@ -15,6 +15,7 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "renoise.h"
+#include "renoise_internal.h"
 #include <string.h>
 #include <math.h>
 
@@ -27,204 +28,888 @@ Renoise_Vector renoise_gradient_point_generate() {
     };
 }
 
+uint64_t renoise_gradient_hash(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t index, uint32_t stream) {
+    return renoise_splitmix64(seed ^ renoise_splitmix64(chunk_x ^ renoise_splitmix64(chunk_y ^ renoise_splitmix64(index ^ ((uint64_t) stream << 32)))));
+}
+
+Renoise_Vector renoise_gradient_point_from_seed(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t index, uint32_t stream) {
+    // Same as renoise_gradient_point_generate, but the angle is a hash of where (and when) the gradient point was made
+    uint64_t hash = renoise_gradient_hash(seed, chunk_x, chunk_y, index, stream);
+    double angle = (hash >> 11) * 0x1.0p-53 * 2*M_PI;
+    return (Renoise_Vector) {
+        .x = cos(angle),
+        .y = sin(angle),
+    };
+}
+
 // **************** **************** **************** **************** **************** ****************
 // ^    ^    ^    ^     ^    ^    ^     ^    ^    ^     ^    ^    ^     ^    ^    ^     ^    ^    ^    ^
 // freq = 1/5 = 0.2
-// count_part = RENOISE_CHUNK_SIZE * freq = 16*0.2 = 3.2
+// count_part = chunk_size * freq = 16*0.2 = 3.2
 // count_extra = count_part % 1
 // gradient_offset = (chunk_pos * count_extra) % 1
 // grad_point_count = ceil(count_part - gradient_offset)
 
+double renoise_grad_offset(int64_t chunk_coord, int64_t chunk_size, double frequency) {
+    double grad_point_size = chunk_size * frequency;
+    double grad_point_size_decimal = fmod(grad_point_size, 1.0);
+
+    // Calculate gradient point offset
+    double grad_offset = chunk_coord * (1.0 - grad_point_size_decimal);
+    // The rounding is to prevent floating point errors from messing with the fmod
+    grad_offset = round(grad_offset / frequency) * frequency;
+    return fmod(grad_offset, 1.0);
+}
+
+int64_t renoise_grad_point_count(double grad_offset, int64_t chunk_size, double frequency) {
+    return ceil(chunk_size * frequency - grad_offset);
+}
+
 Renoise_Chunk* renoise_chunk_generate(int64_t chunk_x, int64_t chunk_y, double frequency) {
+    uint64_t seed = ((uint64_t) rand() << 32) ^ rand();
+    return renoise_chunk_generate_seeded(chunk_x, chunk_y, frequency, seed);
+}
+
+// Allocates the chunk's own points when `points` is NULL. A `frequency_q16` other than 0 puts the chunk on a
+// fixed-point lattice, `frequency` is ignored then. A dormant chunk starts out like an evicted one that never got
+// points: only its streams are allocated, the gradient points get rolled when it's first used.
+static Renoise_Chunk* chunk_generate(int64_t chunk_x, int64_t chunk_y, double frequency, uint32_t frequency_q16, uint64_t seed, int64_t chunk_size, double* points, int64_t points_stride, bool dormant) {
+    assert(chunk_size > 0 && "ERROR: Chunk size should be positive");
+    if (frequency_q16 != 0) frequency = frequency_q16 / 65536.0;
     // TODO: make lower frequencies work
-    assert(RENOISE_CHUNK_SIZE * frequency >= 1.0 && "ERROR: Frequency too low!");
+    assert(chunk_size * frequency >= 1.0 && "ERROR: Frequency too low!");
+    uint64_t stats_start = renoise_stats_begin();
 
     Renoise_Chunk* chunk = malloc(sizeof(Renoise_Chunk));
     memset(chunk, 0, sizeof(Renoise_Chunk));
     chunk->frequency = frequency;
+    chunk->frequency_q16 = frequency_q16;
+    chunk->seed = seed;
     chunk->x = chunk_x;
     chunk->y = chunk_y;
-    double grad_point_size = RENOISE_CHUNK_SIZE * frequency;
-    double grad_point_size_decimal = fmod(grad_point_size, 1.0);
-
-    // Calculate gradient point offset
-    chunk->grad_offset_x = chunk->x * (1.0 - grad_point_size_decimal);
-    chunk->grad_offset_y = chunk->y * (1.0 - grad_point_size_decimal);
-    // The rounding is to prevent floating point errors from messing with the fmod
-    chunk->grad_offset_x = round(chunk->grad_offset_x / chunk->frequency) * chunk->frequency;
-    chunk->grad_offset_y = round(chunk->grad_offset_y / chunk->frequency) * chunk->frequency;
-    chunk->grad_offset_x = fmod(chunk->grad_offset_x, 1.0);
-    chunk->grad_offset_y = fmod(chunk->grad_offset_y, 1.0);
+    chunk->size = chunk_size;
+    chunk->neighbours[1][1] = chunk;
+    if (points == NULL && !dormant) {
+        points = calloc(chunk_size*chunk_size, sizeof(*chunk->points));
+        assert(points != NULL && "ERROR: Out of memory; buy more RAM.");
+        points_stride = chunk_size;
+    }
+    chunk->points = points;
+    chunk->points_stride = points_stride;
 
-    chunk->grad_point_count_x = ceil(grad_point_size - chunk->grad_offset_x);
-    chunk->grad_point_count_y = ceil(grad_point_size - chunk->grad_offset_y);
+    if (frequency_q16 != 0) {
+        // Both terms are multiples of 2^-16 well within 53 bits, so the offsets are exact
+        int64_t first_x = renoise_fixed_first_grad_point(chunk->x, chunk_size, frequency_q16);
+        int64_t first_y = renoise_fixed_first_grad_point(chunk->y, chunk_size, frequency_q16);
+        chunk->grad_offset_x = first_x - chunk->x*chunk_size*frequency;
+        chunk->grad_offset_y = first_y - chunk->y*chunk_size*frequency;
+        chunk->grad_point_count_x = renoise_fixed_first_grad_point(chunk->x + 1, chunk_size, frequency_q16) - first_x;
+        chunk->grad_point_count_y = renoise_fixed_first_grad_point(chunk->y + 1, chunk_size, frequency_q16) - first_y;
+    } else {
+        chunk->grad_offset_x = renoise_grad_offset(chunk->x, chunk_size, frequency);
+        chunk->grad_offset_y = renoise_grad_offset(chunk->y, chunk_size, frequency);
+        chunk->grad_point_count_x = renoise_grad_point_count(chunk->grad_offset_x, chunk_size, frequency);
+        chunk->grad_point_count_y = renoise_grad_point_count(chunk->grad_offset_y, chunk_size, frequency);
+    }
 
     // Generate the gradient points
     int64_t grad_point_count = chunk->grad_point_count_x * chunk->grad_point_count_y;
+    chunk->grad_streams = calloc(grad_point_count, sizeof(*chunk->grad_streams));
+    assert(chunk->grad_streams != NULL && "ERROR: Out of memory; buy more RAM.");
+    if (dormant) {
+        renoise_stats_end(RENOISE_STATS_CHUNK_GENERATE, stats_start);
+        return chunk;
+    }
     chunk->grad_points = malloc(grad_point_count * sizeof(*chunk->grad_points));
     assert(chunk->grad_points != NULL && "ERROR: Out of memory; buy more RAM.");
     for (int64_t i = 0; i < grad_point_count; ++i) {
-        chunk->grad_points[i] = renoise_gradient_point_generate();
+        chunk->grad_points[i] = renoise_chunk_gradient_point(chunk, i, 0);
     }
 
+    if (stats_start != 0) {
+        renoise_stats_count(RENOISE_COUNTER_CHUNKS_GENERATED, 1);
+        renoise_stats_count(RENOISE_COUNTER_GRAD_POINTS_ROLLED, grad_point_count);
+    }
+    renoise_stats_end(RENOISE_STATS_CHUNK_GENERATE, stats_start);
     return chunk;
 }
 
+Renoise_Chunk* renoise_chunk_generate_seeded(int64_t chunk_x, int64_t chunk_y, double frequency, uint64_t seed) {
+    return chunk_generate(chunk_x, chunk_y, frequency, 0, seed, RENOISE_CHUNK_SIZE, NULL, 0, false);
+}
+
 void renoise_chunk_free(Renoise_Chunk* chunk) {
     free(chunk->grad_points);
+    free(chunk->points);
+    free(chunk->grad_streams);
     free(chunk);
 }
 
-Renoise_Vector renoise_chunk_coord_to_gradient_coord(Renoise_Chunk* chunk, uint8_t chunk_x, uint8_t chunk_y) {
+Renoise_Vector renoise_chunk_gradient_point(Renoise_Chunk* chunk, int64_t index, uint32_t stream) {
+    if (chunk->frequency_q16 != 0) return renoise_gradient_point_fixed_from_seed(chunk->seed, chunk->x, chunk->y, index, stream);
+    return renoise_gradient_point_from_seed(chunk->seed, chunk->x, chunk->y, index, stream);
+}
+
+Renoise_Vector renoise_chunk_coord_to_gradient_coord(Renoise_Chunk* chunk, int64_t chunk_x, int64_t chunk_y) {
     return (Renoise_Vector) {
         .x = chunk_x * chunk->frequency - chunk->grad_offset_x,
         .y = chunk_y * chunk->frequency - chunk->grad_offset_y,
     };
 }
 
+static void chunk_reroll_grad_point(Renoise_Chunk* chunk, int64_t index, uint32_t stream) {
+    chunk->grad_streams[index] = stream;
+    chunk->grad_points[index] = renoise_chunk_gradient_point(chunk, index, stream);
+}
+
 Renoise_World* renoise_world_generate(int64_t world_size, double frequency) {
+    uint64_t seed = ((uint64_t) rand() << 32) ^ rand();
+    return renoise_world_generate_seeded(world_size, frequency, seed);
+}
+
+// The chunks in [start, end) on both axes
+typedef struct {
+    int64_t start_x;
+    int64_t start_y;
+    int64_t end_x;
+    int64_t end_y;
+} Chunk_Region;
+
+static bool chunk_region_contains(Chunk_Region region, int64_t chunk_x, int64_t chunk_y) {
+    return chunk_x >= region.start_x && chunk_x < region.end_x && chunk_y >= region.start_y && chunk_y < region.end_y;
+}
+
+// Only the chunks in `region` get their gradient points and points generated, the rest starts out dormant
+static Renoise_World* world_generate(int64_t world_size, int64_t chunk_size, double frequency, uint32_t frequency_q16, uint64_t seed, bool plane, Chunk_Region region) {
+    uint64_t stats_start = renoise_stats_begin();
     Renoise_World* world = malloc(sizeof(Renoise_World));
     memset(world, 0, sizeof(Renoise_World));
+    if (frequency_q16 != 0) frequency = frequency_q16 / 65536.0;
+    world->seed = seed;
     world->frequency = frequency;
+    world->frequency_q16 = frequency_q16;
+    if (frequency_q16 != 0) {
+        world->fixed_scratch = malloc(renoise_fixed_scratch_size(chunk_size, frequency_q16) * sizeof(*world->fixed_scratch));
+        assert(world->fixed_scratch != NULL && "ERROR: Out of memory; buy more RAM.");
+    }
     world->size = world_size;
+    world->chunk_size = chunk_size;
+    if (plane) {
+        world->plane_stride = world->size * chunk_size;
+        world->plane = renoise_plane_alloc(world->plane_stride * world->plane_stride);
+    }
     // Generate the chunks
     world->chunks = malloc(world->size*world->size * sizeof(*world->chunks));
     assert(world->chunks != NULL && "ERROR: Out of memory; buy more RAM.");
+    world->dirty_chunks = calloc((world->size*world->size + 63) / 64, sizeof(*world->dirty_chunks));
+    assert(world->dirty_chunks != NULL && "ERROR: Out of memory; buy more RAM.");
+    world->unpublished_chunks = calloc((world->size*world->size + 63) / 64, sizeof(*world->unpublished_chunks));
+    assert(world->unpublished_chunks != NULL && "ERROR: Out of memory; buy more RAM.");
+    world->published = renoise_published_create(world->size, world->chunk_size);
     for (int64_t i = 0; i < world->size*world->size; ++i) {
         int64_t x = i % world->size;
         int64_t y = i / world->size;
-        world->chunks[i] = renoise_chunk_generate(x, y, frequency);
+        bool dormant = !chunk_region_contains(region, x, y);
+        if (world->plane != NULL) {
+            double* points = &world->plane[x*chunk_size + y*chunk_size * world->plane_stride];
+            world->chunks[i] = chunk_generate(x, y, frequency, frequency_q16, seed, chunk_size, points, world->plane_stride, dormant);
+        } else {
+            world->chunks[i] = chunk_generate(x, y, frequency, frequency_q16, seed, chunk_size, NULL, 0, dormant);
+        }
+        if (dormant) continue;
+        renoise_world_touch_chunk(world, world->chunks[i]);
+        world->resident_size += renoise_chunk_payload_size(world->chunks[i]);
+    }
+    // The chunks only move around in `world->chunks` after this, so the links stay valid for the life of the world
+    for (int64_t i = 0; i < world->size*world->size; ++i) {
+        Renoise_Chunk* chunk = world->chunks[i];
+        for (int64_t dy = -1; dy <= 1; ++dy) {
+            for (int64_t dx = -1; dx <= 1; ++dx) {
+                int64_t x = chunk->x + dx;
+                int64_t y = chunk->y + dy;
+                if (x < 0 || x >= world->size || y < 0 || y >= world->size) continue;
+                chunk->neighbours[dy + 1][dx + 1] = world->chunks[x + y*world->size];
+            }
+        }
     }
 
-    // Generate points for the chunks
+    // Generate points for the chunks; the chunks around the region only get their gradient points restored for the
+    // walk along the border
     for (int64_t world_y = 1; world_y < world->size - 1; ++world_y) {
         for (int64_t world_x = 1; world_x < world->size - 1; ++world_x) {
+            if (!chunk_region_contains(region, world_x, world_y)) continue;
             renoise_world_generate_chunk_points(world, world_x, world_y);
         }
     }
 
+    renoise_stats_end(RENOISE_STATS_WORLD_GENERATE, stats_start);
     return world;
 }
 
+Renoise_World* renoise_world_generate_seeded(int64_t world_size, double frequency, uint64_t seed) {
+    return world_generate(world_size, RENOISE_CHUNK_SIZE, frequency, 0, seed, false, (Chunk_Region) { 0, 0, world_size, world_size });
+}
+
+Renoise_World* renoise_world_generate_sized(int64_t world_size, double frequency, uint64_t seed, int64_t chunk_size) {
+    return world_generate(world_size, chunk_size, frequency, 0, seed, false, (Chunk_Region) { 0, 0, world_size, world_size });
+}
+
+Renoise_World* renoise_world_generate_plane(int64_t world_size, double frequency, uint64_t seed, int64_t chunk_size) {
+    return world_generate(world_size, chunk_size, frequency, 0, seed, true, (Chunk_Region) { 0, 0, world_size, world_size });
+}
+
+Renoise_World* renoise_world_generate_fixed(int64_t world_size, uint32_t frequency_q16, uint64_t seed, int64_t chunk_size) {
+    assert(frequency_q16 != 0 && "ERROR: Frequency too low!");
+    return world_generate(world_size, chunk_size, 0.0, frequency_q16, seed, false, (Chunk_Region) { 0, 0, world_size, world_size });
+}
+
+Renoise_World* renoise_world_generate_region(int64_t world_size, double frequency, uint64_t seed, int64_t chunk_size, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height) {
+    assert(chunk_x >= 0 && chunk_y >= 0 && width >= 0 && height >= 0);
+    assert(chunk_x + width <= world_size && chunk_y + height <= world_size);
+    return world_generate(world_size, chunk_size, frequency, 0, seed, false, (Chunk_Region) { chunk_x, chunk_y, chunk_x + width, chunk_y + height });
+}
+
+static void world_generate_inner_chunk_points(Renoise_World* world) {
+    for (int64_t world_y = 1; world_y < world->size - 1; ++world_y) {
+        for (int64_t world_x = 1; world_x < world->size - 1; ++world_x) {
+            // Dormant chunks get the new points once they're used
+            if (world->chunks[renoise_world_chunk_index(world, world_x, world_y)]->version == 0) continue;
+            renoise_world_generate_chunk_points(world, world_x, world_y);
+        }
+    }
+}
+
+void renoise_world_set_noise(Renoise_World* world, Renoise_Noise noise) {
+    world->noise = noise;
+    world_generate_inner_chunk_points(world);
+}
+
+void renoise_world_set_warp(Renoise_World* world, Renoise_Warp warp) {
+    assert(warp.amplitude >= 0.0 && "ERROR: Warp amplitude can't be negative");
+    assert((warp.amplitude == 0.0 || warp.frequency > 0.0) && "ERROR: Warp frequency should be positive");
+    world->warp = warp;
+    world_generate_inner_chunk_points(world);
+}
+
 void renoise_world_free(Renoise_World* world) {
     for (int64_t i = 0; i < world->size*world->size; ++i) {
+        // The points of the chunks are part of the plane
+        if (world->plane != NULL) world->chunks[i]->points = NULL;
         renoise_chunk_free(world->chunks[i]);
     }
+    renoise_plane_free(world->plane);
     free(world->chunks);
+    free(world->dirty_chunks);
+    free(world->unpublished_chunks);
+    free(world->fixed_scratch);
+    renoise_published_free(world->published);
     free(world);
 }
 
-double perlin_function(double t) {
-    t = fabs(t);
-    if (t >= 1.0) return 0.0;
-    return 1 - (3 - 2*t) * t*t;
+double perlin_falloff(double x, double y, Renoise_Vector gradient) {
+    return renoise_perlin_function(x) * renoise_perlin_function(y) * (x * gradient.x + y * gradient.y);
 }
 
-double perlin_falloff(double x, double y, Renoise_Vector gradient) {
-    return perlin_function(x) * perlin_function(y) * (x * gradient.x + y * gradient.y);
+static inline Renoise_Chunk* world_chunk_with_grad_points(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    Renoise_Chunk* chunk = world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)];
+    if (chunk->grad_points == NULL) renoise_world_restore_grad_points(world, chunk);
+    return chunk;
 }
 
-void renoise_world_generate_chunk_points(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
-    Renoise_Chunk* chunk = world->chunks[chunk_x + chunk_y * world->size];
-
-    for (uint8_t chunk_point_x = 0; chunk_point_x < RENOISE_CHUNK_SIZE; ++chunk_point_x) {
-        for (uint8_t chunk_point_y = 0; chunk_point_y < RENOISE_CHUNK_SIZE; ++chunk_point_y) {
-            // Calculate nearest gradient point to the top-left
-            Renoise_Vector grad_coord = renoise_chunk_coord_to_gradient_coord(chunk, chunk_point_x, chunk_point_y);
-            int64_t grad_cell_x = floor(grad_coord.x);
-            int64_t grad_cell_y = floor(grad_coord.y);
-
-            // Calculate the point based on the four nearest gradient points
-            chunk->points[chunk_point_y][chunk_point_x] = 0.0;
-            for (int64_t grid_x = grad_cell_x; grid_x <= grad_cell_x + 1; ++grid_x) {
-                for (int64_t grid_y = grad_cell_y; grid_y <= grad_cell_y + 1; ++grid_y) {
-                    Renoise_Chunk* query_chunk = chunk;
-                    int64_t query_x = grid_x;
-                    int64_t query_y = grid_y;
-                    int64_t current_chunk_x = chunk_x;
-                    int64_t current_chunk_y = chunk_y;
-                    while (query_x < 0) {
-                        // Use chunk to the left
-                        current_chunk_x -= 1;
-                        assert(current_chunk_x >= 0);
-                        query_chunk = world->chunks[current_chunk_x + current_chunk_y * world->size];
-                        query_x = query_chunk->grad_point_count_x - 1;
-                    }
-                    while (query_x >= query_chunk->grad_point_count_x) {
-                        // Use chunk to the right
-                        current_chunk_x += 1;
-                        assert(current_chunk_x < world->size);
-                        query_chunk = world->chunks[current_chunk_x + current_chunk_y * world->size];
-                        query_x = 0;
-                    }
-                    while (query_y < 0) {
-                        // Use chunk above
-                        current_chunk_y -= 1;
-                        assert(current_chunk_y >= 0);
-                        query_chunk = world->chunks[current_chunk_x + current_chunk_y * world->size];
-                        query_y = query_chunk->grad_point_count_y - 1;
-                    }
-                    while (query_y >= query_chunk->grad_point_count_y) {
-                        // Use chunk below
-                        current_chunk_y += 1;
-                        assert(current_chunk_y < world->size);
-                        query_chunk = world->chunks[current_chunk_x + current_chunk_y * world->size];
-                        query_y = 0;
-                    }
-                    assert(query_x >= 0);
-                    assert(query_x < query_chunk->grad_point_count_x);
-                    assert(query_y >= 0);
-                    assert(query_y < query_chunk->grad_point_count_y);
+#ifdef __GNUC__
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
 
-                    Renoise_Vector grad_point = query_chunk->grad_points[query_x + query_y * query_chunk->grad_point_count_x];
-                    chunk->points[chunk_point_y][chunk_point_x] += perlin_falloff(grad_coord.x - grid_x, grad_coord.y - grid_y, grad_point);
+// The gradient point at (grid_x, grid_y) on the lattice of `chunk`, hopping to the chunk that owns it when it's outside.
+// A corner is never more than one chunk away on either axis, and the counts along an axis are the same for every
+// chunk in that row or column, so one hop over the neighbour links is enough, diagonals included.
+static ALWAYS_INLINE Renoise_Vector world_grad_point(Renoise_World* world, Renoise_Chunk* chunk, int64_t grid_x, int64_t grid_y, uint64_t* neighbour_hops) {
+    int64_t side_x = (grid_x >= chunk->grad_point_count_x) - (grid_x < 0);
+    int64_t side_y = (grid_y >= chunk->grad_point_count_y) - (grid_y < 0);
+    Renoise_Chunk* query_chunk = chunk;
+    int64_t query_x = grid_x;
+    int64_t query_y = grid_y;
+    if (side_x != 0 || side_y != 0) {
+        *neighbour_hops += 1;
+        query_chunk = chunk->neighbours[side_y + 1][side_x + 1];
+        assert(query_chunk != NULL && "ERROR: The chunk needs its neighbours, it can't be on the edge");
+        if (side_x < 0) query_x = query_chunk->grad_point_count_x - 1;
+        if (side_x > 0) query_x = 0;
+        if (side_y < 0) query_y = query_chunk->grad_point_count_y - 1;
+        if (side_y > 0) query_y = 0;
+        if (query_chunk->grad_points == NULL) renoise_world_restore_grad_points(world, query_chunk);
+    }
+    assert(grid_x >= -1 && grid_x <= chunk->grad_point_count_x);
+    assert(grid_y >= -1 && grid_y <= chunk->grad_point_count_y);
+    assert(query_x >= 0);
+    assert(query_x < query_chunk->grad_point_count_x);
+    assert(query_y >= 0);
+    assert(query_y < query_chunk->grad_point_count_y);
+
+    return query_chunk->grad_points[query_x + query_y * query_chunk->grad_point_count_x];
+}
+
+// 1 / the largest sum of simplex_falloff over a triangle, so simplex noise stays within [-1, 1]
+#define SIMPLEX_SCALE 108.0
+
+static double simplex_falloff(double x, double y, Renoise_Vector gradient) {
+    // Radius sqrt(0.5): the distance from a corner to the diagonal of the cells, so a corner's contribution is zero
+    // wherever it isn't a corner of the triangle a point is in
+    double t = 0.5 - x*x - y*y;
+    if (t <= 0.0) return 0.0;
+    t *= t;
+    return t*t * (x * gradient.x + y * gradient.y);
+}
+
+static double value_function(double t) {
+    return (3 - 2*t) * t*t;
+}
+
+// The noise at `grad_coord` on the lattice of `chunk`
+static ALWAYS_INLINE double world_noise(Renoise_World* world, Renoise_Chunk* chunk, Renoise_Vector grad_coord, const Renoise_Noise noise, uint64_t* neighbour_hops) {
+    // Calculate nearest gradient point to the top-left
+    int64_t grad_cell_x = floor(grad_coord.x);
+    int64_t grad_cell_y = floor(grad_coord.y);
+
+    double point = 0.0;
+    switch (noise) {
+    case RENOISE_NOISE_PERLIN:
+        // Calculate the point based on the four nearest gradient points
+        for (int64_t grid_x = grad_cell_x; grid_x <= grad_cell_x + 1; ++grid_x) {
+            for (int64_t grid_y = grad_cell_y; grid_y <= grad_cell_y + 1; ++grid_y) {
+                Renoise_Vector grad_point = world_grad_point(world, chunk, grid_x, grid_y, neighbour_hops);
+                point += perlin_falloff(grad_coord.x - grid_x, grad_coord.y - grid_y, grad_point);
+            }
+        }
+        break;
+    case RENOISE_NOISE_SIMPLEX: {
+        // Every cell is split into two triangles along its diagonal, and only the three corners of the triangle the
+        // point is in contribute
+        double x = grad_coord.x - grad_cell_x;
+        double y = grad_coord.y - grad_cell_y;
+        int64_t middle_x = x >= y ? 1 : 0;
+        int64_t corners[3][2] = { { 0, 0 }, { middle_x, 1 - middle_x }, { 1, 1 } };
+        for (int corner = 0; corner < 3; ++corner) {
+            Renoise_Vector grad_point = world_grad_point(world, chunk, grad_cell_x + corners[corner][0], grad_cell_y + corners[corner][1], neighbour_hops);
+            point += simplex_falloff(x - corners[corner][0], y - corners[corner][1], grad_point);
+        }
+        point *= SIMPLEX_SCALE;
+        break;
+    }
+    case RENOISE_NOISE_VALUE: {
+        // The value of a lattice point is the x of its gradient point, interpolated with the same fade as Perlin
+        double fade_x = value_function(grad_coord.x - grad_cell_x);
+        double fade_y = value_function(grad_coord.y - grad_cell_y);
+        double top_left = world_grad_point(world, chunk, grad_cell_x, grad_cell_y, neighbour_hops).x;
+        double top_right = world_grad_point(world, chunk, grad_cell_x + 1, grad_cell_y, neighbour_hops).x;
+        double bottom_left = world_grad_point(world, chunk, grad_cell_x, grad_cell_y + 1, neighbour_hops).x;
+        double bottom_right = world_grad_point(world, chunk, grad_cell_x + 1, grad_cell_y + 1, neighbour_hops).x;
+        double top = top_left + (top_right - top_left) * fade_x;
+        double bottom = bottom_left + (bottom_right - bottom_left) * fade_x;
+        point = top + (bottom - top) * fade_y;
+        break;
+    }
+    }
+    return point;
+}
+
+// The gradient points of the warp cell the previous sample was in; neighbouring samples are mostly in the same cell
+typedef struct {
+    bool valid;
+    int64_t cell_x;
+    int64_t cell_y;
+    // [corner x][corner y][axis]
+    Renoise_Vector grad_points[2][2][2];
+} Warp_Cache;
+
+// How far the warp moves the sample at (x, y) in samples of the world. The warp noise is Perlin noise on its own
+// lattice that doesn't belong to any chunk, with table gradient points, one set per axis.
+static void warp_displacement(const Renoise_Warp* warp, Warp_Cache* cache, int64_t x, int64_t y, double* displacement_x, double* displacement_y) {
+    Renoise_Vector warp_coord = { .x = x * warp->frequency, .y = y * warp->frequency };
+    int64_t warp_cell_x = floor(warp_coord.x);
+    int64_t warp_cell_y = floor(warp_coord.y);
+    if (!cache->valid || cache->cell_x != warp_cell_x || cache->cell_y != warp_cell_y) {
+        for (int64_t corner_x = 0; corner_x < 2; ++corner_x) {
+            for (int64_t corner_y = 0; corner_y < 2; ++corner_y) {
+                for (int axis = 0; axis < 2; ++axis) {
+                    cache->grad_points[corner_x][corner_y][axis] = renoise_gradient_point_fixed_from_seed(warp->seed, warp_cell_x + corner_x, warp_cell_y + corner_y, axis, 0);
                 }
             }
         }
+        cache->valid = true;
+        cache->cell_x = warp_cell_x;
+        cache->cell_y = warp_cell_y;
+    }
+
+    double displacement[2] = { 0.0, 0.0 };
+    for (int64_t corner_x = 0; corner_x < 2; ++corner_x) {
+        for (int64_t corner_y = 0; corner_y < 2; ++corner_y) {
+            for (int axis = 0; axis < 2; ++axis) {
+                Renoise_Vector grad_point = cache->grad_points[corner_x][corner_y][axis];
+                displacement[axis] += perlin_falloff(warp_coord.x - (warp_cell_x + corner_x), warp_coord.y - (warp_cell_y + corner_y), grad_point);
+            }
+        }
     }
+    // Perlin noise stays within sqrt(0.5)
+    *displacement_x = displacement[0] * M_SQRT2 * warp->amplitude;
+    *displacement_y = displacement[1] * M_SQRT2 * warp->amplitude;
 }
 
-void renoise_world_regenerate_rect(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height) {
+// Stay clear of the last row and column of chunks, which don't have the neighbours to evaluate their points
+static inline double world_warp_clamp(Renoise_World* world, double warped) {
+    double limit = (world->size - 1)*world->chunk_size - 1;
+    return fmin(fmax(warped, 0.0), limit);
+}
+
+// The lattice coordinates of a warped (and clamped) sample in the chunk it lands in, which goes to `target`
+static ALWAYS_INLINE Renoise_Vector world_warp_target(Renoise_World* world, Renoise_Chunk* chunk, double warped_x, double warped_y, Renoise_Chunk** target, uint64_t* neighbour_hops) {
+    int64_t chunk_size = world->chunk_size;
+    int64_t target_x = floor(warped_x / chunk_size);
+    int64_t target_y = floor(warped_y / chunk_size);
+    *target = chunk;
+    if (target_x != chunk->x || target_y != chunk->y) {
+        *neighbour_hops += 1;
+        *target = world_chunk_with_grad_points(world, target_x, target_y);
+    }
+    return (Renoise_Vector) {
+        .x = (warped_x - target_x*chunk_size) * (*target)->frequency - (*target)->grad_offset_x,
+        .y = (warped_y - target_y*chunk_size) * (*target)->frequency - (*target)->grad_offset_y,
+    };
+}
+
+// Fuses the warp into the evaluation: moves the sample, then evaluates the noise wherever it lands, in whichever chunk
+// that is
+static ALWAYS_INLINE double world_warped_point(Renoise_World* world, Renoise_Chunk* chunk, int64_t chunk_point_x, int64_t chunk_point_y, const Renoise_Noise noise, Warp_Cache* warp_cache, uint64_t* neighbour_hops) {
+    int64_t sample_x = chunk->x*world->chunk_size + chunk_point_x;
+    int64_t sample_y = chunk->y*world->chunk_size + chunk_point_y;
+    double displacement_x, displacement_y;
+    warp_displacement(&world->warp, warp_cache, sample_x, sample_y, &displacement_x, &displacement_y);
+    Renoise_Chunk* target;
+    Renoise_Vector grad_coord = world_warp_target(world, chunk, world_warp_clamp(world, sample_x + displacement_x), world_warp_clamp(world, sample_y + displacement_y), &target, neighbour_hops);
+    return world_noise(world, target, grad_coord, noise, neighbour_hops);
+}
+
+static ALWAYS_INLINE double world_chunk_point(Renoise_World* world, Renoise_Chunk* chunk, int64_t chunk_point_x, int64_t chunk_point_y, const Renoise_Noise noise, const bool warped, Warp_Cache* warp_cache, uint64_t* neighbour_hops) {
+    if (warped) return world_warped_point(world, chunk, chunk_point_x, chunk_point_y, noise, warp_cache, neighbour_hops);
+    return world_noise(world, chunk, renoise_chunk_coord_to_gradient_coord(chunk, chunk_point_x, chunk_point_y), noise, neighbour_hops);
+}
+
+// Gets inlined into the kernels below, so the specialised ones see `chunk_size`, `noise` and `warped` as constants
+static ALWAYS_INLINE uint64_t chunk_points_kernel(Renoise_World* world, Renoise_Chunk* chunk, const int64_t chunk_size, const Renoise_Noise noise, const bool warped) {
+    uint64_t neighbour_hops = 0;
+    Warp_Cache warp_cache = {0};
+    for (int64_t chunk_point_y = 0; chunk_point_y < chunk_size; ++chunk_point_y) {
+        for (int64_t chunk_point_x = 0; chunk_point_x < chunk_size; ++chunk_point_x) {
+            chunk->points[chunk_point_x + chunk_point_y * chunk->points_stride] = world_chunk_point(world, chunk, chunk_point_x, chunk_point_y, noise, warped, &warp_cache, &neighbour_hops);
+        }
+    }
+    return neighbour_hops;
+}
+
+#define SPECIALISED_CHUNK_POINTS_KERNEL(size) \
+    static uint64_t chunk_points_kernel_##size(Renoise_World* world, Renoise_Chunk* chunk) { \
+        return chunk_points_kernel(world, chunk, size, RENOISE_NOISE_PERLIN, false); \
+    }
+SPECIALISED_CHUNK_POINTS_KERNEL(8)
+SPECIALISED_CHUNK_POINTS_KERNEL(16)
+SPECIALISED_CHUNK_POINTS_KERNEL(32)
+SPECIALISED_CHUNK_POINTS_KERNEL(64)
+SPECIALISED_CHUNK_POINTS_KERNEL(128)
+SPECIALISED_CHUNK_POINTS_KERNEL(256)
+SPECIALISED_CHUNK_POINTS_KERNEL(512)
+
+// The other kinds of noise are only specialised on the noise
+static uint64_t chunk_points_kernel_simplex(Renoise_World* world, Renoise_Chunk* chunk) {
+    return chunk_points_kernel(world, chunk, chunk->size, RENOISE_NOISE_SIMPLEX, false);
+}
+
+static uint64_t chunk_points_kernel_value(Renoise_World* world, Renoise_Chunk* chunk) {
+    return chunk_points_kernel(world, chunk, chunk->size, RENOISE_NOISE_VALUE, false);
+}
+
+// Warped worlds spend most of their time in the warp, so they aren't specialised at all
+static uint64_t chunk_points_kernel_warped(Renoise_World* world, Renoise_Chunk* chunk) {
+    return chunk_points_kernel(world, chunk, chunk->size, world->noise, true);
+}
+
+void renoise_world_fill_chunk_points(Renoise_World* world, Renoise_Chunk* chunk) {
+    if (chunk->grad_points == NULL) renoise_world_restore_grad_points(world, chunk);
+    if (chunk->points == NULL) {
+        chunk->points = malloc(chunk->size*chunk->size * sizeof(*chunk->points));
+        assert(chunk->points != NULL && "ERROR: Out of memory; buy more RAM.");
+        chunk->points_stride = chunk->size;
+        world->resident_size += chunk->size*chunk->size * sizeof(*chunk->points);
+    }
+
+    uint64_t neighbour_hops = 0;
+    if (world->warp.amplitude > 0.0) {
+        neighbour_hops = chunk_points_kernel_warped(world, chunk);
+    } else switch (world->noise) {
+    case RENOISE_NOISE_SIMPLEX: neighbour_hops = chunk_points_kernel_simplex(world, chunk); break;
+    case RENOISE_NOISE_VALUE:   neighbour_hops = chunk_points_kernel_value(world, chunk);   break;
+    case RENOISE_NOISE_PERLIN:
+        switch (chunk->size) {
+        case 8:   neighbour_hops = chunk_points_kernel_8(world, chunk);   break;
+        case 16:  neighbour_hops = chunk_points_kernel_16(world, chunk);  break;
+        case 32:  neighbour_hops = chunk_points_kernel_32(world, chunk);  break;
+        case 64:  neighbour_hops = chunk_points_kernel_64(world, chunk);  break;
+        case 128: neighbour_hops = chunk_points_kernel_128(world, chunk); break;
+        case 256: neighbour_hops = chunk_points_kernel_256(world, chunk); break;
+        case 512: neighbour_hops = chunk_points_kernel_512(world, chunk); break;
+        default:  neighbour_hops = chunk_points_kernel(world, chunk, chunk->size, RENOISE_NOISE_PERLIN, false); break;
+        }
+        break;
+    }
+    if (renoise_stats_on()) {
+        renoise_stats_count(RENOISE_COUNTER_SAMPLES_EVALUATED, chunk->size*chunk->size);
+        renoise_stats_count(RENOISE_COUNTER_NEIGHBOUR_HOPS, neighbour_hops);
+    }
+}
+
+Renoise_Quantize renoise_quantize_default(Renoise_Quantize_Format format) {
+    switch (format) {
+    case RENOISE_QUANTIZE_UINT8:
+        // Maps [-1, 1] onto [0, 255], the same mapping the examples use for their gray values
+        return (Renoise_Quantize) { .format = format, .scale = 127.5, .bias = 127.5 };
+    case RENOISE_QUANTIZE_INT16:
+        return (Renoise_Quantize) { .format = format, .scale = INT16_MAX, .bias = 0.0 };
+    }
+    assert(false && "ERROR: Unknown quantize format");
+    return (Renoise_Quantize) {0};
+}
+
+void renoise_world_generate_chunk_points(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    uint64_t stats_start = renoise_stats_begin();
+    Renoise_Chunk* chunk = world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)];
+    renoise_world_fill_chunk_points(world, chunk);
+    renoise_world_mark_chunk_changed(world, chunk);
+    renoise_world_touch_chunk(world, chunk);
+    renoise_world_enforce_memory_budget(world);
+    renoise_stats_end(RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS, stats_start);
+}
+
+void renoise_world_generate_chunk_points_quantized(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, Renoise_Quantize quantize, void* dest, int64_t dest_stride) {
+    uint64_t stats_start = renoise_stats_begin();
+    Renoise_Chunk* chunk = world_chunk_with_grad_points(world, chunk_x, chunk_y);
+
+    uint64_t neighbour_hops = 0;
+    Warp_Cache warp_cache = {0};
+    for (int64_t chunk_point_y = 0; chunk_point_y < chunk->size; ++chunk_point_y) {
+        for (int64_t chunk_point_x = 0; chunk_point_x < chunk->size; ++chunk_point_x) {
+            double value = world_chunk_point(world, chunk, chunk_point_x, chunk_point_y, world->noise, world->warp.amplitude > 0.0, &warp_cache, &neighbour_hops) * quantize.scale + quantize.bias;
+            switch (quantize.format) {
+            case RENOISE_QUANTIZE_UINT8:
+                ((uint8_t*) dest)[chunk_point_x + chunk_point_y * dest_stride] = renoise_quantize_uint8(value);
+                break;
+            case RENOISE_QUANTIZE_INT16:
+                ((int16_t*) dest)[chunk_point_x + chunk_point_y * dest_stride] = renoise_quantize_int16(value);
+                break;
+            }
+        }
+    }
+    if (stats_start != 0) {
+        renoise_stats_count(RENOISE_COUNTER_SAMPLES_EVALUATED, chunk->size*chunk->size);
+        renoise_stats_count(RENOISE_COUNTER_NEIGHBOUR_HOPS, neighbour_hops);
+    }
+    renoise_stats_end(RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_QUANTIZED, stats_start);
+}
+
+// The derivative of renoise_perlin_function
+static double perlin_function_derivative(double t) {
+    double u = fabs(t);
+    if (u >= 1.0) return 0.0;
+    double derivative = 6*u * (u - 1);
+    return t < 0.0 ? -derivative : derivative;
+}
+
+// perlin_falloff and its partial derivatives
+static double perlin_falloff_derivatives(double x, double y, Renoise_Vector gradient, double* d_dx, double* d_dy) {
+    double fade_x = renoise_perlin_function(x);
+    double fade_y = renoise_perlin_function(y);
+    double dot = x * gradient.x + y * gradient.y;
+    *d_dx = perlin_function_derivative(x) * fade_y * dot + fade_x * fade_y * gradient.x;
+    *d_dy = fade_x * perlin_function_derivative(y) * dot + fade_x * fade_y * gradient.y;
+    return fade_x * fade_y * dot;
+}
+
+// The partial derivatives of warp_displacement at the sample it was last called for, whose warp cell is still cached:
+// `jacobian[axis][0]` is how much the displacement along `axis` changes per sample along x, `[axis][1]` along y
+static void warp_displacement_jacobian(const Renoise_Warp* warp, const Warp_Cache* cache, int64_t x, int64_t y, double jacobian[2][2]) {
+    Renoise_Vector warp_coord = { .x = x * warp->frequency, .y = y * warp->frequency };
+    assert(cache->valid && cache->cell_x == floor(warp_coord.x) && cache->cell_y == floor(warp_coord.y));
+    for (int axis = 0; axis < 2; ++axis) {
+        jacobian[axis][0] = 0.0;
+        jacobian[axis][1] = 0.0;
+    }
+    for (int64_t corner_x = 0; corner_x < 2; ++corner_x) {
+        for (int64_t corner_y = 0; corner_y < 2; ++corner_y) {
+            for (int axis = 0; axis < 2; ++axis) {
+                double d_dx, d_dy;
+                perlin_falloff_derivatives(warp_coord.x - (cache->cell_x + corner_x), warp_coord.y - (cache->cell_y + corner_y), cache->grad_points[corner_x][corner_y][axis], &d_dx, &d_dy);
+                jacobian[axis][0] += d_dx;
+                jacobian[axis][1] += d_dy;
+            }
+        }
+    }
+    // From the warp lattice to samples, scaled like the displacement
+    for (int axis = 0; axis < 2; ++axis) {
+        jacobian[axis][0] *= warp->frequency * M_SQRT2 * warp->amplitude;
+        jacobian[axis][1] *= warp->frequency * M_SQRT2 * warp->amplitude;
+    }
+}
+
+// world_noise with its partial derivatives along the lattice; the value is computed exactly like world_noise does
+static double world_noise_derivatives(Renoise_World* world, Renoise_Chunk* chunk, Renoise_Vector grad_coord, Renoise_Noise noise, double* d_dx, double* d_dy, uint64_t* neighbour_hops) {
+    int64_t grad_cell_x = floor(grad_coord.x);
+    int64_t grad_cell_y = floor(grad_coord.y);
+
+    double point = 0.0;
+    *d_dx = 0.0;
+    *d_dy = 0.0;
+    switch (noise) {
+    case RENOISE_NOISE_PERLIN:
+        for (int64_t grid_x = grad_cell_x; grid_x <= grad_cell_x + 1; ++grid_x) {
+            for (int64_t grid_y = grad_cell_y; grid_y <= grad_cell_y + 1; ++grid_y) {
+                Renoise_Vector grad_point = world_grad_point(world, chunk, grid_x, grid_y, neighbour_hops);
+                double falloff_dx, falloff_dy;
+                point += perlin_falloff_derivatives(grad_coord.x - grid_x, grad_coord.y - grid_y, grad_point, &falloff_dx, &falloff_dy);
+                *d_dx += falloff_dx;
+                *d_dy += falloff_dy;
+            }
+        }
+        break;
+    case RENOISE_NOISE_SIMPLEX: {
+        double x = grad_coord.x - grad_cell_x;
+        double y = grad_coord.y - grad_cell_y;
+        int64_t middle_x = x >= y ? 1 : 0;
+        int64_t corners[3][2] = { { 0, 0 }, { middle_x, 1 - middle_x }, { 1, 1 } };
+        for (int corner = 0; corner < 3; ++corner) {
+            Renoise_Vector grad_point = world_grad_point(world, chunk, grad_cell_x + corners[corner][0], grad_cell_y + corners[corner][1], neighbour_hops);
+            double corner_x = x - corners[corner][0];
+            double corner_y = y - corners[corner][1];
+            double t = 0.5 - corner_x*corner_x - corner_y*corner_y;
+            if (t <= 0.0) continue;
+            double t2 = t*t;
+            double dot = corner_x * grad_point.x + corner_y * grad_point.y;
+            point += t2*t2 * dot;
+            // d(t^4 dot) = 4 t^3 dt dot + t^4 d(dot), with dt = -2 x dx - 2 y dy
+            *d_dx += -8*t2*t * corner_x * dot + t2*t2 * grad_point.x;
+            *d_dy += -8*t2*t * corner_y * dot + t2*t2 * grad_point.y;
+        }
+        point *= SIMPLEX_SCALE;
+        *d_dx *= SIMPLEX_SCALE;
+        *d_dy *= SIMPLEX_SCALE;
+        break;
+    }
+    case RENOISE_NOISE_VALUE: {
+        double x = grad_coord.x - grad_cell_x;
+        double y = grad_coord.y - grad_cell_y;
+        double fade_x = value_function(x);
+        double fade_y = value_function(y);
+        double top_left = world_grad_point(world, chunk, grad_cell_x, grad_cell_y, neighbour_hops).x;
+        double top_right = world_grad_point(world, chunk, grad_cell_x + 1, grad_cell_y, neighbour_hops).x;
+        double bottom_left = world_grad_point(world, chunk, grad_cell_x, grad_cell_y + 1, neighbour_hops).x;
+        double bottom_right = world_grad_point(world, chunk, grad_cell_x + 1, grad_cell_y + 1, neighbour_hops).x;
+        double top = top_left + (top_right - top_left) * fade_x;
+        double bottom = bottom_left + (bottom_right - bottom_left) * fade_x;
+        point = top + (bottom - top) * fade_y;
+        // The derivative of value_function is 6 t (1 - t)
+        double top_dx = (top_right - top_left) * 6*x * (1 - x);
+        double bottom_dx = (bottom_right - bottom_left) * 6*x * (1 - x);
+        *d_dx = top_dx + (bottom_dx - top_dx) * fade_y;
+        *d_dy = (bottom - top) * 6*y * (1 - y);
+        break;
+    }
+    }
+    return point;
+}
+
+void renoise_world_generate_chunk_points_derivatives(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, double* dest, double* dest_dx, double* dest_dy, int64_t dest_stride) {
+    uint64_t stats_start = renoise_stats_begin();
+    Renoise_Chunk* chunk = world_chunk_with_grad_points(world, chunk_x, chunk_y);
+    const bool warped = world->warp.amplitude > 0.0;
+    Warp_Cache warp_cache = {0};
+
+    uint64_t neighbour_hops = 0;
+    for (int64_t chunk_point_y = 0; chunk_point_y < chunk->size; ++chunk_point_y) {
+        for (int64_t chunk_point_x = 0; chunk_point_x < chunk->size; ++chunk_point_x) {
+            Renoise_Chunk* target = chunk;
+            Renoise_Vector grad_coord;
+            // How far the evaluated position moves per sample: [axis][0] along x, [axis][1] along y
+            double jacobian[2][2] = { { 1.0, 0.0 }, { 0.0, 1.0 } };
+            if (warped) {
+                // Moved like world_warped_point does, so the value stays the same
+                int64_t sample_x = chunk->x*world->chunk_size + chunk_point_x;
+                int64_t sample_y = chunk->y*world->chunk_size + chunk_point_y;
+                double displacement_x, displacement_y;
+                warp_displacement(&world->warp, &warp_cache, sample_x, sample_y, &displacement_x, &displacement_y);
+                warp_displacement_jacobian(&world->warp, &warp_cache, sample_x, sample_y, jacobian);
+                jacobian[0][0] += 1.0;
+                jacobian[1][1] += 1.0;
+                double warped_x = world_warp_clamp(world, sample_x + displacement_x);
+                double warped_y = world_warp_clamp(world, sample_y + displacement_y);
+                // A clamped position doesn't move at all
+                if (warped_x != sample_x + displacement_x) jacobian[0][0] = jacobian[0][1] = 0.0;
+                if (warped_y != sample_y + displacement_y) jacobian[1][0] = jacobian[1][1] = 0.0;
+                grad_coord = world_warp_target(world, chunk, warped_x, warped_y, &target, &neighbour_hops);
+            } else {
+                grad_coord = renoise_chunk_coord_to_gradient_coord(chunk, chunk_point_x, chunk_point_y);
+            }
+            double d_dx, d_dy;
+            double value = world_noise_derivatives(world, target, grad_coord, world->noise, &d_dx, &d_dy, &neighbour_hops);
+            int64_t index = chunk_point_x + chunk_point_y * dest_stride;
+            if (dest != NULL) dest[index] = value;
+            // From the lattice to samples, then through the warp with the chain rule
+            d_dx *= target->frequency;
+            d_dy *= target->frequency;
+            if (warped) {
+                dest_dx[index] = d_dx * jacobian[0][0] + d_dy * jacobian[1][0];
+                dest_dy[index] = d_dx * jacobian[0][1] + d_dy * jacobian[1][1];
+            } else {
+                dest_dx[index] = d_dx;
+                dest_dy[index] = d_dy;
+            }
+        }
+    }
+    if (stats_start != 0) {
+        renoise_stats_count(RENOISE_COUNTER_SAMPLES_EVALUATED, chunk->size*chunk->size);
+        renoise_stats_count(RENOISE_COUNTER_NEIGHBOUR_HOPS, neighbour_hops);
+    }
+    renoise_stats_end(RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_DERIVATIVES, stats_start);
+}
+
+void renoise_chunk_quantize(Renoise_Chunk* chunk, Renoise_Quantize quantize, void* dest, int64_t dest_stride) {
+    assert(chunk->points != NULL && "ERROR: Chunk is evicted, use renoise_world_get_chunk");
+    for (int64_t chunk_point_y = 0; chunk_point_y < chunk->size; ++chunk_point_y) {
+        for (int64_t chunk_point_x = 0; chunk_point_x < chunk->size; ++chunk_point_x) {
+            double value = chunk->points[chunk_point_x + chunk_point_y * chunk->points_stride] * quantize.scale + quantize.bias;
+            switch (quantize.format) {
+            case RENOISE_QUANTIZE_UINT8:
+                ((uint8_t*) dest)[chunk_point_x + chunk_point_y * dest_stride] = renoise_quantize_uint8(value);
+                break;
+            case RENOISE_QUANTIZE_INT16:
+                ((int16_t*) dest)[chunk_point_x + chunk_point_y * dest_stride] = renoise_quantize_int16(value);
+                break;
+            }
+        }
+    }
+}
+
+void renoise_world_roll_grad_points(Renoise_World* world, Renoise_Operation operation, Renoise_Stream_Runs* record, Renoise_Stream_Cursor* restore) {
+    int64_t chunk_x = operation.chunk_x;
+    int64_t chunk_y = operation.chunk_y;
+    int64_t width = operation.width;
+    int64_t height = operation.height;
+    bool full_chunk = operation.kind == RENOISE_OPERATION_REGENERATE_FULL_CHUNK;
+    uint64_t grad_points_rolled = 0;
     for (int64_t world_y = chunk_y; world_y < chunk_y + height; ++world_y) {
         for (int64_t world_x = chunk_x; world_x < chunk_x + width; ++world_x) {
-            int64_t index = world_x + world_y * world->size;
-            Renoise_Chunk* chunk = world->chunks[index];
+            Renoise_Chunk* chunk = world_chunk_with_grad_points(world, world_x, world_y);
             for (int64_t grad_y = 0; grad_y < chunk->grad_point_count_y; ++grad_y) {
                 for (int64_t grad_x = 0; grad_x < chunk->grad_point_count_x; ++grad_x) {
                     // Skip outer gradient vectors
-                    if (world_x == chunk_x && grad_x == 0) continue;
-                    if (world_x == chunk_x + width - 1 && grad_x == chunk->grad_point_count_x - 1) continue;
-                    if (world_y == chunk_y && grad_y == 0) continue;
-                    if (world_y == chunk_y + height - 1 && grad_y == chunk->grad_point_count_y - 1) continue;
+                    if (!full_chunk) {
+                        if (world_x == chunk_x && grad_x == 0) continue;
+                        if (world_x == chunk_x + width - 1 && grad_x == chunk->grad_point_count_x - 1) continue;
+                        if (world_y == chunk_y && grad_y == 0) continue;
+                        if (world_y == chunk_y + height - 1 && grad_y == chunk->grad_point_count_y - 1) continue;
+                    }
 
-                    chunk->grad_points[grad_x + grad_y * chunk->grad_point_count_x] = renoise_gradient_point_generate();
+                    int64_t grad_index = grad_x + grad_y * chunk->grad_point_count_x;
+                    if (record != NULL) renoise_stream_runs_push(record, chunk->grad_streams[grad_index]);
+                    uint32_t stream = restore != NULL ? renoise_stream_cursor_next(restore) : operation.stream;
+                    chunk_reroll_grad_point(chunk, grad_index, stream);
+                    grad_points_rolled += 1;
                 }
             }
+            renoise_world_touch_chunk(world, chunk);
+            renoise_world_enforce_memory_budget(world);
         }
     }
+    if (renoise_stats_on()) renoise_stats_count(RENOISE_COUNTER_GRAD_POINTS_ROLLED, grad_points_rolled);
+}
 
-    // Regenerate chunk points
-    for (int64_t world_y = chunk_y; world_y < chunk_y + height; ++world_y) {
-        if (world_y < 1 || world_y >= world->size - 1) continue;
-        for (int64_t world_x = chunk_x; world_x < chunk_x + width; ++world_x) {
-            if (world_x < 1 || world_x >= world->size - 1) continue;
+void renoise_world_operation_chunks(Renoise_World* world, Renoise_Operation operation, int64_t* start_x, int64_t* start_y, int64_t* end_x, int64_t* end_y) {
+    *start_x = operation.chunk_x;
+    *start_y = operation.chunk_y;
+    *end_x = operation.chunk_x + operation.width;
+    *end_y = operation.chunk_y + operation.height;
+    if (operation.kind == RENOISE_OPERATION_REGENERATE_FULL_CHUNK) {
+        // Regenerating all gradient points of a chunk affects the points of the surrounding chunks
+        *start_x -= 1;
+        *start_y -= 1;
+        *end_x += 1;
+        *end_y += 1;
+    }
+    // The warp can move samples of chunks further away onto the changed gradient points
+    int64_t warp_reach = ceil(world->warp.amplitude / world->chunk_size);
+    *start_x -= warp_reach;
+    *start_y -= warp_reach;
+    *end_x += warp_reach;
+    *end_y += warp_reach;
+
+    // Only inner chunks have points
+    if (*start_x < 1) *start_x = 1;
+    if (*start_y < 1) *start_y = 1;
+    if (*end_x > world->size - 1) *end_x = world->size - 1;
+    if (*end_y > world->size - 1) *end_y = world->size - 1;
+    if (*end_x < *start_x) *end_x = *start_x;
+    if (*end_y < *start_y) *end_y = *start_y;
+}
+
+void renoise_world_regenerate_operation_points(Renoise_World* world, Renoise_Operation operation) {
+    int64_t start_x, start_y, end_x, end_y;
+    renoise_world_operation_chunks(world, operation, &start_x, &start_y, &end_x, &end_y);
+    for (int64_t world_y = start_y; world_y < end_y; ++world_y) {
+        for (int64_t world_x = start_x; world_x < end_x; ++world_x) {
             renoise_world_generate_chunk_points(world, world_x, world_y);
         }
     }
 }
 
-void renoise_world_regenerate_full_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
-    Renoise_Chunk* chunk = world->chunks[chunk_x + chunk_y * world->size];
-    for (int64_t grad_index = 0; grad_index < chunk->grad_point_count_x * chunk->grad_point_count_y; ++grad_index) {
-        chunk->grad_points[grad_index] = renoise_gradient_point_generate();
-    }
+void renoise_world_roll_operation(Renoise_World* world, Renoise_Operation operation) {
+    if (operation.stream > world->rng_stream) world->rng_stream = operation.stream;
 
-    // Regenerate chunk points
-    for (int64_t world_y = chunk_y - 1; world_y <= chunk_y + 1; ++world_y) {
-        if (world_y < 1 || world_y >= world->size - 1) continue;
-        for (int64_t world_x = chunk_x - 1; world_x <= chunk_x + 1; ++world_x) {
-            if (world_x < 1 || world_x >= world->size - 1) continue;
-            renoise_world_generate_chunk_points(world, world_x, world_y);
-        }
+    Renoise_Stream_Runs* record = NULL;
+    if (world->journal != NULL) record = renoise_journal_record(world->journal, operation);
+    renoise_world_roll_grad_points(world, operation, record, NULL);
+}
+
+void renoise_world_apply_operation(Renoise_World* world, Renoise_Operation operation) {
+    uint64_t stats_start = renoise_stats_begin();
+    renoise_world_roll_operation(world, operation);
+    renoise_world_regenerate_operation_points(world, operation);
+
+    switch (operation.kind) {
+    case RENOISE_OPERATION_REGENERATE_RECT:
+        renoise_stats_end(RENOISE_STATS_WORLD_REGENERATE_RECT, stats_start);
+        break;
+    case RENOISE_OPERATION_REGENERATE_FULL_CHUNK:
+        renoise_stats_end(RENOISE_STATS_WORLD_REGENERATE_FULL_CHUNK, stats_start);
+        break;
     }
 }
+
+void renoise_world_regenerate_rect(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height) {
+    renoise_world_apply_operation(world, (Renoise_Operation) {
+        .kind = RENOISE_OPERATION_REGENERATE_RECT,
+        .chunk_x = chunk_x,
+        .chunk_y = chunk_y,
+        .width = width,
+        .height = height,
+        .stream = world->rng_stream + 1,
+    });
+}
+
+void renoise_world_regenerate_full_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    renoise_world_apply_operation(world, (Renoise_Operation) {
+        .kind = RENOISE_OPERATION_REGENERATE_FULL_CHUNK,
+        .chunk_x = chunk_x,
+        .chunk_y = chunk_y,
+        .width = 1,
+        .height = 1,
+        .stream = world->rng_stream + 1,
+    });
+}
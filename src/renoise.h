@@ -22,39 +22,537 @@
 
 #define RENOISE_VERSION "0.2.0"
 
+// The chunk size of 3D chunks, and of 2D chunks and worlds that aren't given one
+#ifndef RENOISE_CHUNK_SIZE
 #define RENOISE_CHUNK_SIZE 16
-static_assert(RENOISE_CHUNK_SIZE >= 0 && RENOISE_CHUNK_SIZE < 256, "RENOISE_CHUNK_SIZE should fit in an unsigned 8-bit integer");
+#endif
+
+// The width and height in chunks of a tile, see RENOISE_CHUNK_ORDER_TILED
+#ifndef RENOISE_CHUNK_TILE_SIZE
+#define RENOISE_CHUNK_TILE_SIZE 4
+#endif
+static_assert((RENOISE_CHUNK_TILE_SIZE & (RENOISE_CHUNK_TILE_SIZE - 1)) == 0, "RENOISE_CHUNK_TILE_SIZE should be a power of two");
 
 typedef struct {
     double x;
     double y;
 } Renoise_Vector;
 
-typedef struct {
+typedef struct Renoise_Chunk Renoise_Chunk;
+struct Renoise_Chunk {
     int64_t x;
     int64_t y;
     double frequency;
+    // The frequency in 16.16 fixed point for chunks of a fixed-point world, 0 otherwise
+    uint32_t frequency_q16;
+    uint64_t seed;
+
+    // The width and height of the chunk in points
+    int64_t size;
 
     Renoise_Vector* grad_points;
     int64_t grad_point_count_x;
     int64_t grad_point_count_y;
+    // The RNG stream each gradient point was last rolled with; together with the seed this is enough to
+    // regenerate the gradient points, so this is all that's kept when a chunk gets evicted
+    uint32_t* grad_streams;
     double grad_offset_x;
     double grad_offset_y;
-    double points[RENOISE_CHUNK_SIZE][RENOISE_CHUNK_SIZE];
-} Renoise_Chunk;
+    // NULL while the chunk is evicted, use renoise_world_get_chunk to access the points of a world's chunk.
+    // Row-major: the point at (x, y) is points[x + y * points_stride].
+    double* points;
+    int64_t points_stride;
+
+    // Eviction bookkeeping, see renoise_world_tick and renoise_world_set_memory_budget
+    uint64_t last_access;
+    Renoise_Chunk* lru_prev;
+    Renoise_Chunk* lru_next;
+
+    // neighbours[dy + 1][dx + 1] is the chunk at (x + dx, y + dy) in the same world, NULL past the world's edge;
+    // neighbours[1][1] is the chunk itself. Chunks generated on their own only have themselves.
+    Renoise_Chunk* neighbours[3][3];
+
+    // The world version at which the points last changed (0 = never got points), see renoise_world_chunk_version.
+    // Only goes up, also when an undo brings back earlier points; recomputing the points of an evicted chunk
+    // keeps it.
+    uint64_t version;
+};
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} Renoise_Cache_Counters;
+
+typedef enum {
+    RENOISE_OPERATION_REGENERATE_RECT,
+    RENOISE_OPERATION_REGENERATE_FULL_CHUNK,
+} Renoise_Operation_Kind;
+
+// A regeneration, described compactly enough to undo or replay it
+typedef struct {
+    Renoise_Operation_Kind kind;
+    int64_t chunk_x;
+    int64_t chunk_y;
+    int64_t width;
+    int64_t height;
+    // The RNG stream the gradient points get rolled with
+    uint32_t stream;
+} Renoise_Operation;
+
+typedef struct {
+    uint32_t count;
+    uint32_t stream;
+} Renoise_Stream_Run;
+
+typedef struct {
+    Renoise_Stream_Run* items;
+    int64_t count;
+    int64_t capacity;
+} Renoise_Stream_Runs;
+
+typedef struct {
+    Renoise_Operation operation;
+    // The streams of the rolled gradient points before the operation, in the order they got rolled
+    Renoise_Stream_Runs previous_streams;
+} Renoise_Journal_Entry;
+
+typedef struct {
+    Renoise_Journal_Entry* entries;
+    int64_t count;
+    int64_t capacity;
+    // Entries before `position` are applied, the ones from `position` on can be redone
+    int64_t position;
+} Renoise_Journal;
+
+typedef enum {
+    RENOISE_CHUNK_ORDER_ROW_MAJOR,
+    // Experimental: tiles of RENOISE_CHUNK_TILE_SIZE^2 chunks, row-major inside and between the tiles, so the chunks
+    // around a chunk are mostly in the same tile. The tiles on the right and bottom edge are narrower when the world
+    // size isn't a multiple of the tile size, which keeps `chunks` without gaps. So far bench measures it within a few
+    // percent of row-major, which stays the default.
+    RENOISE_CHUNK_ORDER_TILED,
+} Renoise_Chunk_Order;
+
+// How the points are made from the gradient points around them. Every kind uses the same lattice and gradient points,
+// so regenerating works the same for all of them.
+typedef enum {
+    // Four gradient points per sample
+    RENOISE_NOISE_PERLIN,
+    // Three gradient points per sample: every cell is split into two triangles, only the corners of the triangle a
+    // sample is in contribute
+    RENOISE_NOISE_SIMPLEX,
+    // Four lattice points per sample, but only interpolates their values (the x of their gradient point); the
+    // cheapest and the blockiest
+    RENOISE_NOISE_VALUE,
+} Renoise_Noise;
 
+// Domain warping: every sample gets moved by another noise field before the world's noise is evaluated there
 typedef struct {
+    // How far a sample gets moved at most, in samples; 0 turns warping off
+    double amplitude;
+    // The frequency of the warp noise, in gradient points per sample like the world's frequency
+    double frequency;
+    uint64_t seed;
+} Renoise_Warp;
+
+// The points of every chunk as of the last renoise_world_publish, see renoise_snapshot.c
+typedef struct Renoise_Published Renoise_Published;
+
+typedef struct {
+    // Index with renoise_world_chunk_index
     Renoise_Chunk** chunks;
+    Renoise_Chunk_Order chunk_order;
+    // RENOISE_NOISE_PERLIN unless changed with renoise_world_set_noise
+    Renoise_Noise noise;
+    // No warping unless changed with renoise_world_set_warp
+    Renoise_Warp warp;
     int64_t size;
+    // The size of every chunk of the world; the kernels are specialised for the powers of two from 8 to 512
+    int64_t chunk_size;
     double frequency;
+    // The frequency in 16.16 fixed point when the world was generated with renoise_world_generate_fixed, 0 otherwise
+    uint32_t frequency_q16;
+    // Scratch space of renoise_world_generate_chunk_points_fixed, sized for the world's chunks; NULL unless fixed-point
+    int32_t* fixed_scratch;
+    uint64_t seed;
+    // All points of the world in one row-major plane of `size * chunk_size` samples square, when the world
+    // was generated with renoise_world_generate_plane; the chunks' points point into it. NULL otherwise.
+    double* plane;
+    int64_t plane_stride;
+    // Incremented for every regeneration, so every regeneration rolls different gradient points
+    uint32_t rng_stream;
+    // Records every regeneration when not NULL, see renoise_world_undo
+    Renoise_Journal* journal;
+
+    // Chunks that haven't been accessed for `cold_after` ticks get evicted by renoise_world_tick (0 = never)
+    uint64_t cold_after;
+    uint64_t tick;
+
+    // Least recently used chunks get evicted when the gradient points and points of all chunks
+    // take up more than `memory_budget` bytes (0 = unlimited), see renoise_world_set_memory_budget
+    int64_t memory_budget;
+    int64_t resident_size;
+    Renoise_Chunk* lru_head;
+    Renoise_Chunk* lru_tail;
+    Renoise_Cache_Counters cache;
+
+    // Incremented every time the points of a chunk change, so it's the highest version of any chunk
+    uint64_t version;
+    // One bit per chunk whose points changed since they were last drained
+    uint64_t* dirty_chunks;
+    int64_t dirty_count;
+    Renoise_Published* published;
+    // One bit per chunk, row by row whatever the chunk order, whose points changed since the last renoise_world_publish
+    uint64_t* unpublished_chunks;
 } Renoise_World;
 
+// Where the chunk at (chunk_x, chunk_y) is in `world->chunks`
+static inline int64_t renoise_world_chunk_index(const Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    switch (world->chunk_order) {
+    case RENOISE_CHUNK_ORDER_ROW_MAJOR:
+        break;
+    case RENOISE_CHUNK_ORDER_TILED: {
+        int64_t tile_x = chunk_x & ~(int64_t) (RENOISE_CHUNK_TILE_SIZE - 1);
+        int64_t tile_y = chunk_y & ~(int64_t) (RENOISE_CHUNK_TILE_SIZE - 1);
+        int64_t tile_width = world->size - tile_x < RENOISE_CHUNK_TILE_SIZE ? world->size - tile_x : RENOISE_CHUNK_TILE_SIZE;
+        int64_t tile_height = world->size - tile_y < RENOISE_CHUNK_TILE_SIZE ? world->size - tile_y : RENOISE_CHUNK_TILE_SIZE;
+        return tile_y * world->size + tile_x * tile_height + (chunk_y - tile_y) * tile_width + (chunk_x - tile_x);
+    }
+    }
+    return chunk_x + chunk_y * world->size;
+}
+
+typedef struct {
+    int64_t chunk_x;
+    int64_t chunk_y;
+    // The chunk's version when it got drained
+    uint64_t version;
+} Renoise_Chunk_Change;
+
+// A regeneration whose points get recomputed a few chunks at a time, see renoise_world_begin_operation
+typedef struct {
+    Renoise_World* world;
+    Renoise_Operation operation;
+    // The inner chunks whose points the operation affects, recomputed row by row
+    int64_t start_x;
+    int64_t start_y;
+    int64_t width;
+    int64_t height;
+    int64_t chunks_done;
+} Renoise_Regeneration;
+
+// How much work a call to renoise_regeneration_step may do; 0 means no limit. A step always recomputes at least one
+// chunk, and stops before the chunk that would go over `samples` or once `time_ns` has passed.
+typedef struct {
+    int64_t samples;
+    uint64_t time_ns;
+} Renoise_Work_Budget;
+
+// A regeneration that fades from the old points to the new ones, see renoise_world_begin_crossfade
+typedef struct {
+    Renoise_World* world;
+    // The inner chunks whose points the operation affects
+    int64_t start_x;
+    int64_t start_y;
+    int64_t width;
+    int64_t height;
+    // The points of those chunks before and after the operation, `world->chunk_size` squared per chunk, row by row
+    double* old_points;
+    double* new_points;
+    double t;
+} Renoise_Crossfade;
+
+typedef enum {
+    RENOISE_VIEW_AABB,
+    RENOISE_VIEW_TRIANGLE,
+    RENOISE_VIEW_FRUSTUM,
+} Renoise_View_Kind;
+
+// A shape in samples that sees every chunk it overlaps
+typedef struct {
+    Renoise_View_Kind kind;
+    // AABB: the minimum and the maximum corner. Triangle: its three corners. Frustum: the four corners of a 2D view
+    // frustum in order around it (near left, near right, far right, far left). Either winding works.
+    Renoise_Vector points[4];
+} Renoise_View;
+
+// Chunks as `chunk_x + chunk_y * world->size`
+typedef struct {
+    int64_t* items;
+    int64_t count;
+    int64_t capacity;
+} Renoise_Chunk_List;
+
+// Which chunks are seen, kept up to date with renoise_visibility_update
+typedef struct {
+    Renoise_World* world;
+    // Regenerates every chunk that stops being visible, off by default. Chunks that are still visible never change:
+    // a hidden chunk gets a full chunk regeneration when none of the chunks that changes are visible, and otherwise only
+    // has the gradient points inside it rolled, like a regenerate_rect of just that chunk. In warped worlds, where even
+    // that can change visible chunks, it's left as it is.
+    bool regenerate_hidden;
+    // The chunks the views overlapped on the last update, and the ones that became visible and stopped being visible
+    Renoise_Chunk_List visible;
+    Renoise_Chunk_List shown;
+    Renoise_Chunk_List hidden;
+    // One bit per chunk in `visible`
+    uint64_t* visible_bits;
+    // The visible chunks of the update before, and a cleared bit set to swap with `visible_bits`
+    Renoise_Chunk_List previous;
+    uint64_t* previous_bits;
+} Renoise_Visibility;
+
+// A consistent view of the world's points as of one renoise_world_publish, see renoise_world_snapshot. Every reader
+// of the same publish shares it; the points themselves are behind renoise_snapshot_chunk_points.
+typedef struct {
+    int64_t size;
+    int64_t chunk_size;
+    // The world version at the publish
+    uint64_t version;
+} Renoise_Snapshot;
+
+typedef enum {
+    RENOISE_QUANTIZE_UINT8,
+    RENOISE_QUANTIZE_INT16,
+} Renoise_Quantize_Format;
+
+// A quantized sample is `point * scale + bias`, rounded and saturated to the range of `format`
+typedef struct {
+    Renoise_Quantize_Format format;
+    double scale;
+    double bias;
+} Renoise_Quantize;
+
 Renoise_Vector renoise_gradient_point_generate();
+Renoise_Vector renoise_gradient_point_from_seed(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t index, uint32_t stream);
+// Same, but picked from the fixed table of gradient points of fixed-point worlds; cheaper and the same on every platform
+Renoise_Vector renoise_gradient_point_fixed_from_seed(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t index, uint32_t stream);
 Renoise_Chunk* renoise_chunk_generate(int64_t chunk_x, int64_t chunk_y, double frequency);
+Renoise_Chunk* renoise_chunk_generate_seeded(int64_t chunk_x, int64_t chunk_y, double frequency, uint64_t seed);
 void renoise_chunk_free(Renoise_Chunk* chunk);
-Renoise_Vector renoise_chunk_coord_to_gradient_coord(Renoise_Chunk* chunk, uint8_t chunk_x, uint8_t chunk_y);
+Renoise_Vector renoise_chunk_coord_to_gradient_coord(Renoise_Chunk* chunk, int64_t chunk_x, int64_t chunk_y);
 Renoise_World* renoise_world_generate(int64_t world_size, double frequency);
+Renoise_World* renoise_world_generate_seeded(int64_t world_size, double frequency, uint64_t seed);
+// Generates a world with chunks of `chunk_size` by `chunk_size` points instead of RENOISE_CHUNK_SIZE
+Renoise_World* renoise_world_generate_sized(int64_t world_size, double frequency, uint64_t seed, int64_t chunk_size);
+// Generates a world whose points all live in `world->plane`, so regions can be read without copying.
+// Its chunks can't be evicted.
+Renoise_World* renoise_world_generate_plane(int64_t world_size, double frequency, uint64_t seed, int64_t chunk_size);
+// Generates a world whose lattice is in integer coordinates and whose gradient points come from a fixed table, so
+// renoise_world_generate_chunk_points_fixed gives the same bits on every platform. `frequency_q16` is the frequency
+// in 16.16 fixed point. The regular kernels work on it too, they just aren't bit-exact across platforms.
+Renoise_World* renoise_world_generate_fixed(int64_t world_size, uint32_t frequency_q16, uint64_t seed, int64_t chunk_size);
+// Generates only the chunks in the rectangle of chunks at (chunk_x, chunk_y), plus the gradient points of the chunks
+// around it that its border needs. All other chunks start out dormant, like evicted chunks that never had points:
+// they get generated the first time they're used (renoise_world_get_chunk, renoise_world_read_region, a
+// regeneration), with the same points an eagerly generated world would have, and show up in the change feed then.
+Renoise_World* renoise_world_generate_region(int64_t world_size, double frequency, uint64_t seed, int64_t chunk_size, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height);
+// Reorders `world->chunks`, and reallocates the gradient points and points of the chunks in the new order.
+// Experimental, see RENOISE_CHUNK_ORDER_TILED.
+void renoise_world_set_chunk_order(Renoise_World* world, Renoise_Chunk_Order order);
+// Switches the world to another kind of noise and recomputes the points of all inner chunks
+void renoise_world_set_noise(Renoise_World* world, Renoise_Noise noise);
+// Warps the world's noise and recomputes the points of all inner chunks. The warp is evaluated together with the
+// noise, per sample; regenerating recomputes the points of every chunk whose samples can be moved onto the changes.
+void renoise_world_set_warp(Renoise_World* world, Renoise_Warp warp);
 void renoise_world_free(Renoise_World* world);
 void renoise_world_generate_chunk_points(Renoise_World* world, int64_t chunk_x, int64_t chunk_y);
 void renoise_world_regenerate_rect(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height);
 void renoise_world_regenerate_full_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y);
+// Applies a regeneration with a given stream, so the exact same gradient points get rolled every time
+void renoise_world_apply_operation(Renoise_World* world, Renoise_Operation operation);
+// Time-sliced regeneration: rolls the gradient points (and records the operation in the journal) right away, but
+// leaves recomputing the points to renoise_regeneration_step. Until it's done, the affected chunks have the points
+// from before. Other regenerations may run in between; the world must outlive the regeneration.
+Renoise_Regeneration renoise_world_begin_operation(Renoise_World* world, Renoise_Operation operation);
+Renoise_Regeneration renoise_world_begin_regenerate_rect(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height);
+Renoise_Regeneration renoise_world_begin_regenerate_full_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y);
+// Recomputes the points of the next chunks within `budget`. Returns true once every chunk is done.
+bool renoise_regeneration_step(Renoise_Regeneration* regeneration, Renoise_Work_Budget budget);
+// From 0 to 1
+double renoise_regeneration_progress(const Renoise_Regeneration* regeneration);
+// Cross-faded regeneration: applies the operation (rolling the gradient points and recording it in the journal), but
+// keeps the points from before and the points after, and leaves the world showing the old points (t = 0).
+// The noise is linear in the gradient points, so the points for gradient points blended at t are the points blended
+// at t; renoise_crossfade_set only lerps the two. Evicting a chunk mid-fade jumps it to the new points.
+Renoise_Crossfade* renoise_world_begin_crossfade(Renoise_World* world, Renoise_Operation operation);
+Renoise_Crossfade* renoise_world_crossfade_rect(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height);
+Renoise_Crossfade* renoise_world_crossfade_full_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y);
+// Sets the points of the affected chunks to the blend at `t` (0 = old, 1 = new, both exact) and marks them changed
+void renoise_crossfade_set(Renoise_Crossfade* crossfade, double t);
+// Leaves the points as they are, set t to 1 first to finish the fade
+void renoise_crossfade_free(Renoise_Crossfade* crossfade);
+
+// Snapshots: lets other threads read the world while one thread keeps changing it. The writer calls
+// renoise_world_publish after a batch of changes to make the changed chunks visible; unchanged chunks are shared with
+// earlier publishes. Readers may call renoise_world_snapshot at any time, and read the snapshot until they free it,
+// also after the world got freed. Nothing else of the world may be touched by the readers.
+void renoise_world_publish(Renoise_World* world);
+Renoise_Snapshot* renoise_world_snapshot(Renoise_World* world);
+// The points of a chunk, row-major with a stride of `snapshot->chunk_size`; NULL if it was never published
+const double* renoise_snapshot_chunk_points(const Renoise_Snapshot* snapshot, int64_t chunk_x, int64_t chunk_y);
+// The chunk's version when it got published, 0 if it never was
+uint64_t renoise_snapshot_chunk_version(const Renoise_Snapshot* snapshot, int64_t chunk_x, int64_t chunk_y);
+void renoise_snapshot_free(Renoise_Snapshot* snapshot);
+
+// Visibility: the caller passes this frame's views, and only the chunks under this frame's and the last frame's
+// views get looked at, so an update costs the visible area instead of the world size
+Renoise_Visibility* renoise_visibility_create(Renoise_World* world);
+void renoise_visibility_update(Renoise_Visibility* visibility, const Renoise_View* views, int64_t view_count);
+bool renoise_visibility_is_visible(const Renoise_Visibility* visibility, int64_t chunk_x, int64_t chunk_y);
+void renoise_visibility_free(Renoise_Visibility* visibility);
+Renoise_Quantize renoise_quantize_default(Renoise_Quantize_Format format);
+// Like renoise_world_generate_chunk_points, but writes quantized samples to `dest` instead of the chunk's points.
+// `dest` is a uint8_t or int16_t buffer (depending on `quantize.format`), `dest_stride` is measured in samples.
+void renoise_world_generate_chunk_points_quantized(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, Renoise_Quantize quantize, void* dest, int64_t dest_stride);
+void renoise_chunk_quantize(Renoise_Chunk* chunk, Renoise_Quantize quantize, void* dest, int64_t dest_stride);
+// Integer-only Perlin kernel for worlds generated with renoise_world_generate_fixed: writes the points of an inner chunk
+// as Q15 (point * 32768, saturated) to `dest`, without touching the chunk's own points. `dest_stride` is measured
+// in samples. Its output is bit-exact across platforms. `./nob bench` measures it at 0.2x to 0.5x the
+// ns per sample of renoise_world_generate_chunk_points, depending on chunk size and frequency. It works in `world->fixed_scratch`, so only one
+// thread at a time may call it on the same world.
+void renoise_world_generate_chunk_points_fixed(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int16_t* dest, int64_t dest_stride);
+// Writes the points of an inner chunk to `dest` (skipped when NULL), the same values renoise_world_generate_chunk_points
+// gives, together with their exact partial derivatives per sample to `dest_dx` and `dest_dy`, in one pass. The chunk's
+// own points are left alone. In warped worlds they're the derivatives of the warped noise, warp included.
+void renoise_world_generate_chunk_points_derivatives(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, double* dest, double* dest_dx, double* dest_dy, int64_t dest_stride);
+
+// Chunk eviction: chunks that sit idle or don't fit in the memory budget are evicted down to their RNG streams, and
+// transparently regenerated when accessed. Evictions by renoise_world_tick count in `world->cache.evictions` too.
+void renoise_world_tick(Renoise_World* world);
+Renoise_Chunk* renoise_world_get_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y);
+int64_t renoise_chunk_memory_usage(Renoise_Chunk* chunk);
+int64_t renoise_world_memory_usage(Renoise_World* world);
+void renoise_world_set_memory_budget(Renoise_World* world, int64_t memory_budget);
+void renoise_world_evict_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y);
+bool renoise_chunk_is_evicted(Renoise_Chunk* chunk);
+
+// Operation journal: set `world->journal` to a journal to record regenerations, so they can be undone and replayed
+Renoise_Journal* renoise_journal_create();
+void renoise_journal_free(Renoise_Journal* journal);
+void renoise_journal_clear(Renoise_Journal* journal);
+bool renoise_world_undo(Renoise_World* world);
+bool renoise_world_redo(Renoise_World* world);
+// Applies the applied operations of a journal to a world, a world with the same seed, size, frequency, noise and
+// warp as the journal's world ends up with the same gradient points and points
+void renoise_world_replay(Renoise_World* world, const Renoise_Journal* journal);
+
+// Change feed: every chunk whose points got (re)generated is marked dirty until it's drained. Evicted chunks
+// getting their points recomputed don't count as a change.
+// Writes up to `max_changes` dirty chunks to `changes`, in the order of `world->chunks`, and marks them clean again.
+// Returns how many got written; call it until it returns 0 to drain everything.
+int64_t renoise_world_drain_changes(Renoise_World* world, Renoise_Chunk_Change* changes, int64_t max_changes);
+// Versions: whatever got built from a chunk's points is still up to date as long as the chunk's version is the same
+// as when it got built. Unlike renoise_world_get_chunk, these never bring back the points of an evicted chunk, nor
+// count as an access.
+uint64_t renoise_world_chunk_version(const Renoise_World* world, int64_t chunk_x, int64_t chunk_y);
+
+// Statistics: off by default, turn them on with renoise_stats_enable. Counters are accumulated per thread,
+// renoise_stats_snapshot sums them over all threads that ever used the library.
+typedef enum {
+    RENOISE_STATS_CHUNK_GENERATE,
+    RENOISE_STATS_WORLD_GENERATE,
+    RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS,
+    RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_QUANTIZED,
+    RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_FIXED,
+    RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_DERIVATIVES,
+    RENOISE_STATS_WORLD_REGENERATE_RECT,
+    RENOISE_STATS_WORLD_REGENERATE_FULL_CHUNK,
+    RENOISE_STATS_WORLD_UNDO,
+    RENOISE_STATS_WORLD_REDO,
+    RENOISE_STATS_WORLD_GET_CHUNK,
+    RENOISE_STATS_WORLD_TICK,
+    RENOISE_STATS_REGENERATION_STEP,
+    RENOISE_STATS_VISIBILITY_UPDATE,
+    RENOISE_STATS_FUNCTION_COUNT,
+} Renoise_Stats_Function;
+
+typedef struct {
+    uint64_t chunks_generated;
+    uint64_t samples_evaluated;
+    uint64_t grad_points_rolled;
+    // Times the corner lookup had to go to a neighbouring chunk for a gradient point
+    uint64_t neighbour_hops;
+    uint64_t calls[RENOISE_STATS_FUNCTION_COUNT];
+    // Includes the time spent in other public functions called by the function
+    uint64_t time_ns[RENOISE_STATS_FUNCTION_COUNT];
+} Renoise_Stats;
+
+void renoise_stats_enable(bool enable);
+Renoise_Stats renoise_stats_snapshot();
+const char* renoise_stats_function_name(Renoise_Stats_Function function);
+
+// 3D (volumetric) noise. Works like the 2D chunks and worlds, but points are floats to keep the
+// RENOISE_CHUNK_SIZE^3 samples of a chunk small.
+typedef struct {
+    double x;
+    double y;
+    double z;
+} Renoise_Vector3;
+
+typedef struct {
+    int64_t x;
+    int64_t y;
+    int64_t z;
+    double frequency;
+    uint64_t seed;
+
+    Renoise_Vector3* grad_points;
+    int64_t grad_point_count_x;
+    int64_t grad_point_count_y;
+    int64_t grad_point_count_z;
+    double grad_offset_x;
+    double grad_offset_y;
+    double grad_offset_z;
+    float (*points)[RENOISE_CHUNK_SIZE][RENOISE_CHUNK_SIZE];
+} Renoise_Chunk3;
+
+typedef struct {
+    Renoise_Chunk3** chunks;
+    int64_t size;
+    double frequency;
+    uint64_t seed;
+    uint32_t rng_stream;
+} Renoise_World3;
+
+Renoise_Vector3 renoise_gradient_point3_from_seed(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z, int64_t index, uint32_t stream);
+Renoise_Chunk3* renoise_chunk3_generate_seeded(int64_t chunk_x, int64_t chunk_y, int64_t chunk_z, double frequency, uint64_t seed);
+void renoise_chunk3_free(Renoise_Chunk3* chunk);
+Renoise_World3* renoise_world3_generate(int64_t world_size, double frequency);
+Renoise_World3* renoise_world3_generate_seeded(int64_t world_size, double frequency, uint64_t seed);
+void renoise_world3_free(Renoise_World3* world);
+Renoise_Chunk3* renoise_world3_get_chunk(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z);
+void renoise_world3_generate_chunk_points(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z);
+void renoise_world3_regenerate_box(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z, int64_t width, int64_t height, int64_t depth);
+void renoise_world3_regenerate_full_chunk(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z);
+
+// A rectangle of samples (not chunks) in world coordinates
+typedef struct {
+    int64_t x;
+    int64_t y;
+    int64_t width;
+    int64_t height;
+} Renoise_Rect;
+
+// RGBA colours for the 256 values of a sample quantized with renoise_quantize_default(RENOISE_QUANTIZE_UINT8)
+typedef struct {
+    uint8_t colors[256][4];
+} Renoise_Palette;
+
+Renoise_Palette renoise_palette_grayscale();
+// Writes the samples in `region` as RGBA pixels to `rgba`, `stride` is the number of bytes between two rows.
+// A NULL palette means grayscale.
+// These and the region reads below use multiple threads only when the library is built with OpenMP, which is off by
+// default; see the README.
+void renoise_world_rasterize(Renoise_World* world, Renoise_Rect region, uint8_t* rgba, int64_t stride, const Renoise_Palette* palette);
+// Copies the samples in `region` to `dest`, `dest_stride` is the number of elements between two rows.
+// The int16 variant quantizes like renoise_quantize_default(RENOISE_QUANTIZE_INT16).
+void renoise_world_read_region(Renoise_World* world, Renoise_Rect region, double* dest, int64_t dest_stride);
+void renoise_world_read_region_float(Renoise_World* world, Renoise_Rect region, float* dest, int64_t dest_stride);
+void renoise_world_read_region_int16(Renoise_World* world, Renoise_Rect region, int16_t* dest, int64_t dest_stride);
+// Writes the partial derivatives of the samples in `region`, see renoise_world_generate_chunk_points_derivatives.
+// They're computed on the fly; the derivatives of the edge chunks, which have no points, are 0.
+void renoise_world_read_region_derivatives(Renoise_World* world, Renoise_Rect region, double* dest_dx, double* dest_dy, int64_t dest_stride);
+// The highest version of the chunks that overlap `region`, see renoise_world_chunk_version
+uint64_t renoise_world_region_version(const Renoise_World* world, Renoise_Rect region);
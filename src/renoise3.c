@@ -0,0 +1,287 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <string.h>
+#include <math.h>
+
+// 2D worlds take their chunk size at runtime, only the 3D chunks are still built around RENOISE_CHUNK_SIZE
+static_assert(RENOISE_CHUNK_SIZE > 0 && RENOISE_CHUNK_SIZE < 256, "RENOISE_CHUNK_SIZE should be between 1 and 255, 3D chunks hold RENOISE_CHUNK_SIZE^3 points and keep rows of RENOISE_CHUNK_SIZE samples on the stack");
+
+Renoise_Vector3 renoise_gradient_point3_from_seed(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z, int64_t index, uint32_t stream) {
+    uint64_t hash = renoise_splitmix64(seed ^ renoise_splitmix64(chunk_x ^ renoise_splitmix64(chunk_y ^ renoise_splitmix64(chunk_z ^ renoise_splitmix64(index ^ ((uint64_t) stream << 32))))));
+    // A uniformly distributed direction: uniform height on the z axis, uniform angle around it
+    double z = (hash >> 32) * 0x1.0p-32 * 2.0 - 1.0;
+    double angle = (hash & 0xFFFFFFFF) * 0x1.0p-32 * 2*M_PI;
+    double radius = sqrt(1.0 - z*z);
+    return (Renoise_Vector3) {
+        .x = radius * cos(angle),
+        .y = radius * sin(angle),
+        .z = z,
+    };
+}
+
+Renoise_Chunk3* renoise_chunk3_generate_seeded(int64_t chunk_x, int64_t chunk_y, int64_t chunk_z, double frequency, uint64_t seed) {
+    // TODO: make lower frequencies work
+    assert(RENOISE_CHUNK_SIZE * frequency >= 1.0 && "ERROR: Frequency too low!");
+
+    Renoise_Chunk3* chunk = malloc(sizeof(Renoise_Chunk3));
+    assert(chunk != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(chunk, 0, sizeof(Renoise_Chunk3));
+    chunk->frequency = frequency;
+    chunk->seed = seed;
+    chunk->x = chunk_x;
+    chunk->y = chunk_y;
+    chunk->z = chunk_z;
+    chunk->points = calloc(RENOISE_CHUNK_SIZE, sizeof(*chunk->points));
+    assert(chunk->points != NULL && "ERROR: Out of memory; buy more RAM.");
+
+    chunk->grad_offset_x = renoise_grad_offset(chunk->x, RENOISE_CHUNK_SIZE, frequency);
+    chunk->grad_offset_y = renoise_grad_offset(chunk->y, RENOISE_CHUNK_SIZE, frequency);
+    chunk->grad_offset_z = renoise_grad_offset(chunk->z, RENOISE_CHUNK_SIZE, frequency);
+    chunk->grad_point_count_x = renoise_grad_point_count(chunk->grad_offset_x, RENOISE_CHUNK_SIZE, frequency);
+    chunk->grad_point_count_y = renoise_grad_point_count(chunk->grad_offset_y, RENOISE_CHUNK_SIZE, frequency);
+    chunk->grad_point_count_z = renoise_grad_point_count(chunk->grad_offset_z, RENOISE_CHUNK_SIZE, frequency);
+
+    int64_t grad_point_count = chunk->grad_point_count_x * chunk->grad_point_count_y * chunk->grad_point_count_z;
+    chunk->grad_points = malloc(grad_point_count * sizeof(*chunk->grad_points));
+    assert(chunk->grad_points != NULL && "ERROR: Out of memory; buy more RAM.");
+    for (int64_t i = 0; i < grad_point_count; ++i) {
+        chunk->grad_points[i] = renoise_gradient_point3_from_seed(chunk->seed, chunk->x, chunk->y, chunk->z, i, 0);
+    }
+
+    return chunk;
+}
+
+void renoise_chunk3_free(Renoise_Chunk3* chunk) {
+    free(chunk->grad_points);
+    free(chunk->points);
+    free(chunk);
+}
+
+Renoise_World3* renoise_world3_generate(int64_t world_size, double frequency) {
+    uint64_t seed = ((uint64_t) rand() << 32) ^ rand();
+    return renoise_world3_generate_seeded(world_size, frequency, seed);
+}
+
+Renoise_World3* renoise_world3_generate_seeded(int64_t world_size, double frequency, uint64_t seed) {
+    Renoise_World3* world = malloc(sizeof(Renoise_World3));
+    assert(world != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(world, 0, sizeof(Renoise_World3));
+    world->seed = seed;
+    world->frequency = frequency;
+    world->size = world_size;
+    // Generate the chunks
+    int64_t chunk_count = world->size*world->size*world->size;
+    world->chunks = malloc(chunk_count * sizeof(*world->chunks));
+    assert(world->chunks != NULL && "ERROR: Out of memory; buy more RAM.");
+    for (int64_t i = 0; i < chunk_count; ++i) {
+        int64_t x = i % world->size;
+        int64_t y = i / world->size % world->size;
+        int64_t z = i / (world->size*world->size);
+        world->chunks[i] = renoise_chunk3_generate_seeded(x, y, z, frequency, seed);
+    }
+
+    // Generate points for the chunks
+    for (int64_t world_z = 1; world_z < world->size - 1; ++world_z) {
+        for (int64_t world_y = 1; world_y < world->size - 1; ++world_y) {
+            for (int64_t world_x = 1; world_x < world->size - 1; ++world_x) {
+                renoise_world3_generate_chunk_points(world, world_x, world_y, world_z);
+            }
+        }
+    }
+
+    return world;
+}
+
+void renoise_world3_free(Renoise_World3* world) {
+    for (int64_t i = 0; i < world->size*world->size*world->size; ++i) {
+        renoise_chunk3_free(world->chunks[i]);
+    }
+    free(world->chunks);
+    free(world);
+}
+
+Renoise_Chunk3* renoise_world3_get_chunk(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z) {
+    assert(chunk_x >= 0 && chunk_x < world->size);
+    assert(chunk_y >= 0 && chunk_y < world->size);
+    assert(chunk_z >= 0 && chunk_z < world->size);
+    return world->chunks[chunk_x + (chunk_y + chunk_z * world->size) * world->size];
+}
+
+// Everything about one sample coordinate along one axis that doesn't depend on the other axes: the two gradient
+// points it lies between (as a neighbour chunk -1, 0 or 1 and an index into that chunk), its distance to them and
+// the falloff for those distances. Because the falloff is separable, the 3D kernel only combines these.
+typedef struct {
+    int8_t neighbour[2];
+    int64_t index[2];
+    double distance[2];
+    double falloff[2];
+} Axis_Sample;
+
+static void axis_samples(Axis_Sample samples[RENOISE_CHUNK_SIZE], double frequency, double grad_offset, int64_t grad_point_count, int64_t previous_grad_point_count) {
+    for (int64_t i = 0; i < RENOISE_CHUNK_SIZE; ++i) {
+        double grad_coord = i * frequency - grad_offset;
+        int64_t grad_cell = floor(grad_coord);
+        for (int corner = 0; corner < 2; ++corner) {
+            int64_t grid = grad_cell + corner;
+            Axis_Sample* sample = &samples[i];
+            if (grid < 0) {
+                // Use the chunk before this one
+                sample->neighbour[corner] = -1;
+                sample->index[corner] = previous_grad_point_count - 1;
+            } else if (grid >= grad_point_count) {
+                // Use the chunk after this one
+                sample->neighbour[corner] = 1;
+                sample->index[corner] = grid - grad_point_count;
+            } else {
+                sample->neighbour[corner] = 0;
+                sample->index[corner] = grid;
+            }
+            sample->distance[corner] = grad_coord - grid;
+            sample->falloff[corner] = renoise_perlin_function(sample->distance[corner]);
+        }
+    }
+}
+
+void renoise_world3_generate_chunk_points(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z) {
+    assert(chunk_x >= 1 && chunk_x < world->size - 1);
+    assert(chunk_y >= 1 && chunk_y < world->size - 1);
+    assert(chunk_z >= 1 && chunk_z < world->size - 1);
+    Renoise_Chunk3* chunk = renoise_world3_get_chunk(world, chunk_x, chunk_y, chunk_z);
+
+    // The 3x3x3 chunks the gradient points can come from
+    Renoise_Chunk3* neighbours[3][3][3];
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                neighbours[dz + 1][dy + 1][dx + 1] = renoise_world3_get_chunk(world, chunk_x + dx, chunk_y + dy, chunk_z + dz);
+            }
+        }
+    }
+
+    Axis_Sample samples_x[RENOISE_CHUNK_SIZE];
+    Axis_Sample samples_y[RENOISE_CHUNK_SIZE];
+    Axis_Sample samples_z[RENOISE_CHUNK_SIZE];
+    axis_samples(samples_x, chunk->frequency, chunk->grad_offset_x, chunk->grad_point_count_x, neighbours[1][1][0]->grad_point_count_x);
+    axis_samples(samples_y, chunk->frequency, chunk->grad_offset_y, chunk->grad_point_count_y, neighbours[1][0][1]->grad_point_count_y);
+    axis_samples(samples_z, chunk->frequency, chunk->grad_offset_z, chunk->grad_point_count_z, neighbours[0][1][1]->grad_point_count_z);
+
+    // Along x the distances and falloffs are laid out in arrays, so the inner loops are plain arithmetic the compiler
+    // can vectorise; only looking up the gradient points is a gather
+    double distance_x[2][RENOISE_CHUNK_SIZE];
+    double falloff_x[2][RENOISE_CHUNK_SIZE];
+    for (int corner = 0; corner < 2; ++corner) {
+        for (int64_t x = 0; x < RENOISE_CHUNK_SIZE; ++x) {
+            distance_x[corner][x] = samples_x[x].distance[corner];
+            falloff_x[corner][x] = samples_x[x].falloff[corner];
+        }
+    }
+
+    double row[RENOISE_CHUNK_SIZE];
+    double grad_x[RENOISE_CHUNK_SIZE];
+    double grad_yz[RENOISE_CHUNK_SIZE];
+    for (int64_t z = 0; z < RENOISE_CHUNK_SIZE; ++z) {
+        Axis_Sample* sample_z = &samples_z[z];
+        for (int64_t y = 0; y < RENOISE_CHUNK_SIZE; ++y) {
+            Axis_Sample* sample_y = &samples_y[y];
+            memset(row, 0, sizeof(row));
+            for (int corner_z = 0; corner_z < 2; ++corner_z) {
+                for (int corner_y = 0; corner_y < 2; ++corner_y) {
+                    double falloff_yz = sample_y->falloff[corner_y] * sample_z->falloff[corner_z];
+                    if (falloff_yz == 0.0) continue;
+                    double distance_y = sample_y->distance[corner_y];
+                    double distance_z = sample_z->distance[corner_z];
+                    Renoise_Chunk3* (*plane)[3] = neighbours[sample_z->neighbour[corner_z] + 1];
+                    for (int corner_x = 0; corner_x < 2; ++corner_x) {
+                        // Gather the gradient points for this corner
+                        for (int64_t x = 0; x < RENOISE_CHUNK_SIZE; ++x) {
+                            Axis_Sample* sample_x = &samples_x[x];
+                            Renoise_Chunk3* query_chunk = plane[sample_y->neighbour[corner_y] + 1][sample_x->neighbour[corner_x] + 1];
+                            int64_t index = sample_x->index[corner_x] + (sample_y->index[corner_y] + sample_z->index[corner_z] * query_chunk->grad_point_count_y) * query_chunk->grad_point_count_x;
+                            Renoise_Vector3 grad_point = query_chunk->grad_points[index];
+                            grad_x[x] = grad_point.x;
+                            grad_yz[x] = grad_point.y * distance_y + grad_point.z * distance_z;
+                        }
+                        // Trilinear falloff times the dot product of the gradient point and the distance
+                        for (int64_t x = 0; x < RENOISE_CHUNK_SIZE; ++x) {
+                            row[x] += falloff_yz * falloff_x[corner_x][x] * (grad_x[x] * distance_x[corner_x][x] + grad_yz[x]);
+                        }
+                    }
+                }
+            }
+            for (int64_t x = 0; x < RENOISE_CHUNK_SIZE; ++x) {
+                chunk->points[z][y][x] = row[x];
+            }
+        }
+    }
+}
+
+static void world3_generate_points_in_box(Renoise_World3* world, int64_t start_x, int64_t start_y, int64_t start_z, int64_t end_x, int64_t end_y, int64_t end_z) {
+    for (int64_t world_z = start_z; world_z < end_z; ++world_z) {
+        if (world_z < 1 || world_z >= world->size - 1) continue;
+        for (int64_t world_y = start_y; world_y < end_y; ++world_y) {
+            if (world_y < 1 || world_y >= world->size - 1) continue;
+            for (int64_t world_x = start_x; world_x < end_x; ++world_x) {
+                if (world_x < 1 || world_x >= world->size - 1) continue;
+                renoise_world3_generate_chunk_points(world, world_x, world_y, world_z);
+            }
+        }
+    }
+}
+
+void renoise_world3_regenerate_box(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z, int64_t width, int64_t height, int64_t depth) {
+    uint32_t stream = ++world->rng_stream;
+    for (int64_t world_z = chunk_z; world_z < chunk_z + depth; ++world_z) {
+        for (int64_t world_y = chunk_y; world_y < chunk_y + height; ++world_y) {
+            for (int64_t world_x = chunk_x; world_x < chunk_x + width; ++world_x) {
+                Renoise_Chunk3* chunk = renoise_world3_get_chunk(world, world_x, world_y, world_z);
+                for (int64_t grad_z = 0; grad_z < chunk->grad_point_count_z; ++grad_z) {
+                    for (int64_t grad_y = 0; grad_y < chunk->grad_point_count_y; ++grad_y) {
+                        for (int64_t grad_x = 0; grad_x < chunk->grad_point_count_x; ++grad_x) {
+                            // Skip outer gradient vectors
+                            if (world_x == chunk_x && grad_x == 0) continue;
+                            if (world_x == chunk_x + width - 1 && grad_x == chunk->grad_point_count_x - 1) continue;
+                            if (world_y == chunk_y && grad_y == 0) continue;
+                            if (world_y == chunk_y + height - 1 && grad_y == chunk->grad_point_count_y - 1) continue;
+                            if (world_z == chunk_z && grad_z == 0) continue;
+                            if (world_z == chunk_z + depth - 1 && grad_z == chunk->grad_point_count_z - 1) continue;
+
+                            int64_t grad_index = grad_x + (grad_y + grad_z * chunk->grad_point_count_y) * chunk->grad_point_count_x;
+                            chunk->grad_points[grad_index] = renoise_gradient_point3_from_seed(chunk->seed, chunk->x, chunk->y, chunk->z, grad_index, stream);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Regenerate chunk points
+    world3_generate_points_in_box(world, chunk_x, chunk_y, chunk_z, chunk_x + width, chunk_y + height, chunk_z + depth);
+}
+
+void renoise_world3_regenerate_full_chunk(Renoise_World3* world, int64_t chunk_x, int64_t chunk_y, int64_t chunk_z) {
+    Renoise_Chunk3* chunk = renoise_world3_get_chunk(world, chunk_x, chunk_y, chunk_z);
+    uint32_t stream = ++world->rng_stream;
+    int64_t grad_point_count = chunk->grad_point_count_x * chunk->grad_point_count_y * chunk->grad_point_count_z;
+    for (int64_t grad_index = 0; grad_index < grad_point_count; ++grad_index) {
+        chunk->grad_points[grad_index] = renoise_gradient_point3_from_seed(chunk->seed, chunk->x, chunk->y, chunk->z, grad_index, stream);
+    }
+
+    // Regenerate chunk points, this affects the surrounding chunks too
+    world3_generate_points_in_box(world, chunk_x - 1, chunk_y - 1, chunk_z - 1, chunk_x + 2, chunk_y + 2, chunk_z + 2);
+}
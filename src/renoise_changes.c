@@ -0,0 +1,73 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "renoise.h"
+#include "renoise_internal.h"
+void renoise_world_mark_chunk_changed(Renoise_World* world, Renoise_Chunk* chunk) {
+    chunk->version = ++world->version;
+    int64_t index = renoise_world_chunk_index(world, chunk->x, chunk->y);
+    uint64_t bit = (uint64_t) 1 << (index % 64);
+    if ((world->dirty_chunks[index / 64] & bit) == 0) {
+        world->dirty_chunks[index / 64] |= bit;
+        world->dirty_count += 1;
+    }
+    int64_t slot = chunk->x + chunk->y * world->size;
+    world->unpublished_chunks[slot / 64] |= (uint64_t) 1 << (slot % 64);
+}
+
+int64_t renoise_world_drain_changes(Renoise_World* world, Renoise_Chunk_Change* changes, int64_t max_changes) {
+    int64_t drained = 0;
+    int64_t word_count = (world->size*world->size + 63) / 64;
+    // Skips clean stretches of the world 64 chunks at a time
+    for (int64_t word = 0; word < word_count && world->dirty_count > 0 && drained < max_changes; ++word) {
+        while (world->dirty_chunks[word] != 0 && drained < max_changes) {
+            uint64_t bits = world->dirty_chunks[word];
+            int64_t index = word * 64 + renoise_lowest_set_bit(bits);
+            world->dirty_chunks[word] = bits & (bits - 1);
+            world->dirty_count -= 1;
+
+            Renoise_Chunk* chunk = world->chunks[index];
+            changes[drained++] = (Renoise_Chunk_Change) {
+                .chunk_x = chunk->x,
+                .chunk_y = chunk->y,
+                .version = chunk->version,
+            };
+        }
+    }
+    return drained;
+}
+
+uint64_t renoise_world_chunk_version(const Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    assert(chunk_x >= 0 && chunk_x < world->size);
+    assert(chunk_y >= 0 && chunk_y < world->size);
+    return world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)]->version;
+}
+
+uint64_t renoise_world_region_version(const Renoise_World* world, Renoise_Rect region) {
+    assert(region.x >= 0 && region.y >= 0);
+    assert(region.x + region.width <= world->size * world->chunk_size);
+    assert(region.y + region.height <= world->size * world->chunk_size);
+    if (region.width <= 0 || region.height <= 0) return 0;
+
+    uint64_t version = 0;
+    for (int64_t chunk_y = region.y / world->chunk_size; chunk_y <= (region.y + region.height - 1) / world->chunk_size; ++chunk_y) {
+        for (int64_t chunk_x = region.x / world->chunk_size; chunk_x <= (region.x + region.width - 1) / world->chunk_size; ++chunk_x) {
+            uint64_t chunk_version = world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)]->version;
+            if (chunk_version > version) version = chunk_version;
+        }
+    }
+    return version;
+}
@@ -0,0 +1,224 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <stdlib.h>
+#include <assert.h>
+
+// Fixed-point worlds: the lattice lives in 16.16 fixed point and the gradient points come from this table of unit
+// vectors in Q14 (cos and sin of i/256 of a turn, rounded), so nothing depends on the platform's libm or FPU.
+static const int16_t fixed_gradients[256][2] = {
+    { 16384, 0 }, { 16379, 402 }, { 16364, 804 }, { 16340, 1205 }, { 16305, 1606 }, { 16261, 2006 }, { 16207, 2404 }, { 16143, 2801 },
+    { 16069, 3196 }, { 15986, 3590 }, { 15893, 3981 }, { 15791, 4370 }, { 15679, 4756 }, { 15557, 5139 }, { 15426, 5520 }, { 15286, 5897 },
+    { 15137, 6270 }, { 14978, 6639 }, { 14811, 7005 }, { 14635, 7366 }, { 14449, 7723 }, { 14256, 8076 }, { 14053, 8423 }, { 13842, 8765 },
+    { 13623, 9102 }, { 13395, 9434 }, { 13160, 9760 }, { 12916, 10080 }, { 12665, 10394 }, { 12406, 10702 }, { 12140, 11003 }, { 11866, 11297 },
+    { 11585, 11585 }, { 11297, 11866 }, { 11003, 12140 }, { 10702, 12406 }, { 10394, 12665 }, { 10080, 12916 }, { 9760, 13160 }, { 9434, 13395 },
+    { 9102, 13623 }, { 8765, 13842 }, { 8423, 14053 }, { 8076, 14256 }, { 7723, 14449 }, { 7366, 14635 }, { 7005, 14811 }, { 6639, 14978 },
+    { 6270, 15137 }, { 5897, 15286 }, { 5520, 15426 }, { 5139, 15557 }, { 4756, 15679 }, { 4370, 15791 }, { 3981, 15893 }, { 3590, 15986 },
+    { 3196, 16069 }, { 2801, 16143 }, { 2404, 16207 }, { 2006, 16261 }, { 1606, 16305 }, { 1205, 16340 }, { 804, 16364 }, { 402, 16379 },
+    { 0, 16384 }, { -402, 16379 }, { -804, 16364 }, { -1205, 16340 }, { -1606, 16305 }, { -2006, 16261 }, { -2404, 16207 }, { -2801, 16143 },
+    { -3196, 16069 }, { -3590, 15986 }, { -3981, 15893 }, { -4370, 15791 }, { -4756, 15679 }, { -5139, 15557 }, { -5520, 15426 }, { -5897, 15286 },
+    { -6270, 15137 }, { -6639, 14978 }, { -7005, 14811 }, { -7366, 14635 }, { -7723, 14449 }, { -8076, 14256 }, { -8423, 14053 }, { -8765, 13842 },
+    { -9102, 13623 }, { -9434, 13395 }, { -9760, 13160 }, { -10080, 12916 }, { -10394, 12665 }, { -10702, 12406 }, { -11003, 12140 }, { -11297, 11866 },
+    { -11585, 11585 }, { -11866, 11297 }, { -12140, 11003 }, { -12406, 10702 }, { -12665, 10394 }, { -12916, 10080 }, { -13160, 9760 }, { -13395, 9434 },
+    { -13623, 9102 }, { -13842, 8765 }, { -14053, 8423 }, { -14256, 8076 }, { -14449, 7723 }, { -14635, 7366 }, { -14811, 7005 }, { -14978, 6639 },
+    { -15137, 6270 }, { -15286, 5897 }, { -15426, 5520 }, { -15557, 5139 }, { -15679, 4756 }, { -15791, 4370 }, { -15893, 3981 }, { -15986, 3590 },
+    { -16069, 3196 }, { -16143, 2801 }, { -16207, 2404 }, { -16261, 2006 }, { -16305, 1606 }, { -16340, 1205 }, { -16364, 804 }, { -16379, 402 },
+    { -16384, 0 }, { -16379, -402 }, { -16364, -804 }, { -16340, -1205 }, { -16305, -1606 }, { -16261, -2006 }, { -16207, -2404 }, { -16143, -2801 },
+    { -16069, -3196 }, { -15986, -3590 }, { -15893, -3981 }, { -15791, -4370 }, { -15679, -4756 }, { -15557, -5139 }, { -15426, -5520 }, { -15286, -5897 },
+    { -15137, -6270 }, { -14978, -6639 }, { -14811, -7005 }, { -14635, -7366 }, { -14449, -7723 }, { -14256, -8076 }, { -14053, -8423 }, { -13842, -8765 },
+    { -13623, -9102 }, { -13395, -9434 }, { -13160, -9760 }, { -12916, -10080 }, { -12665, -10394 }, { -12406, -10702 }, { -12140, -11003 }, { -11866, -11297 },
+    { -11585, -11585 }, { -11297, -11866 }, { -11003, -12140 }, { -10702, -12406 }, { -10394, -12665 }, { -10080, -12916 }, { -9760, -13160 }, { -9434, -13395 },
+    { -9102, -13623 }, { -8765, -13842 }, { -8423, -14053 }, { -8076, -14256 }, { -7723, -14449 }, { -7366, -14635 }, { -7005, -14811 }, { -6639, -14978 },
+    { -6270, -15137 }, { -5897, -15286 }, { -5520, -15426 }, { -5139, -15557 }, { -4756, -15679 }, { -4370, -15791 }, { -3981, -15893 }, { -3590, -15986 },
+    { -3196, -16069 }, { -2801, -16143 }, { -2404, -16207 }, { -2006, -16261 }, { -1606, -16305 }, { -1205, -16340 }, { -804, -16364 }, { -402, -16379 },
+    { 0, -16384 }, { 402, -16379 }, { 804, -16364 }, { 1205, -16340 }, { 1606, -16305 }, { 2006, -16261 }, { 2404, -16207 }, { 2801, -16143 },
+    { 3196, -16069 }, { 3590, -15986 }, { 3981, -15893 }, { 4370, -15791 }, { 4756, -15679 }, { 5139, -15557 }, { 5520, -15426 }, { 5897, -15286 },
+    { 6270, -15137 }, { 6639, -14978 }, { 7005, -14811 }, { 7366, -14635 }, { 7723, -14449 }, { 8076, -14256 }, { 8423, -14053 }, { 8765, -13842 },
+    { 9102, -13623 }, { 9434, -13395 }, { 9760, -13160 }, { 10080, -12916 }, { 10394, -12665 }, { 10702, -12406 }, { 11003, -12140 }, { 11297, -11866 },
+    { 11585, -11585 }, { 11866, -11297 }, { 12140, -11003 }, { 12406, -10702 }, { 12665, -10394 }, { 12916, -10080 }, { 13160, -9760 }, { 13395, -9434 },
+    { 13623, -9102 }, { 13842, -8765 }, { 14053, -8423 }, { 14256, -8076 }, { 14449, -7723 }, { 14635, -7366 }, { 14811, -7005 }, { 14978, -6639 },
+    { 15137, -6270 }, { 15286, -5897 }, { 15426, -5520 }, { 15557, -5139 }, { 15679, -4756 }, { 15791, -4370 }, { 15893, -3981 }, { 15986, -3590 },
+    { 16069, -3196 }, { 16143, -2801 }, { 16207, -2404 }, { 16261, -2006 }, { 16305, -1606 }, { 16340, -1205 }, { 16364, -804 }, { 16379, -402 },
+};
+
+// Note: the kernel relies on >> of a negative int32_t being an arithmetic shift, which every compiler we target does
+
+int64_t renoise_fixed_first_grad_point(int64_t chunk_coord, int64_t chunk_size, uint32_t frequency_q16) {
+    // ceil(chunk_coord * chunk_size * frequency)
+    return (chunk_coord * chunk_size * frequency_q16 + 0xFFFF) >> 16;
+}
+
+Renoise_Vector renoise_gradient_point_fixed_from_seed(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t index, uint32_t stream) {
+    const int16_t* gradient = fixed_gradients[renoise_gradient_hash(seed, chunk_x, chunk_y, index, stream) >> 56];
+    return (Renoise_Vector) {
+        .x = gradient[0] / 16384.0,
+        .y = gradient[1] / 16384.0,
+    };
+}
+
+// The chunk (c-1, c or c+1) owning global gradient point `grad_point` on one axis
+static int64_t fixed_owner_chunk(int64_t chunk_coord, int64_t grad_point, int64_t chunk_size, uint32_t frequency_q16) {
+    if (grad_point < renoise_fixed_first_grad_point(chunk_coord, chunk_size, frequency_q16)) return chunk_coord - 1;
+    if (grad_point >= renoise_fixed_first_grad_point(chunk_coord + 1, chunk_size, frequency_q16)) return chunk_coord + 1;
+    return chunk_coord;
+}
+
+// The most gradient points the samples of one chunk fall between along one axis, plus the corner past the last cell
+static int64_t fixed_max_grid_size(int64_t chunk_size, uint32_t frequency_q16) {
+    return (((chunk_size - 1)*frequency_q16 + 0xFFFF) >> 16) + 2;
+}
+
+int64_t renoise_fixed_scratch_size(int64_t chunk_size, uint32_t frequency_q16) {
+    // The gradient grid, both axes, and the four corner gradients of the current row
+    int64_t grid_size = fixed_max_grid_size(chunk_size, frequency_q16);
+    return 2*grid_size*grid_size + 10*chunk_size + 8*chunk_size;
+}
+
+typedef struct {
+    int32_t* cell;
+    int32_t* weight0;
+    int32_t* weight1;
+    int32_t* delta0;
+    int32_t* delta1;
+} Fixed_Axis;
+
+// Everything along one axis of the chunk that doesn't depend on the other axis: the cell each sample falls in
+// (relative to the first gradient point `lowest`) and its fade weights and distances to both sides of the cell, in Q15
+static void fixed_axis_precompute(Fixed_Axis axis, int64_t chunk_coord, int64_t chunk_size, uint32_t frequency_q16, int64_t lowest) {
+    for (int64_t i = 0; i < chunk_size; ++i) {
+        int64_t position = (chunk_coord*chunk_size + i) * frequency_q16;
+        int64_t t = (position & 0xFFFF) >> 1;
+        int64_t t2 = (t*t + (1 << 14)) >> 15;
+        int64_t fade = (t2 * (3*32768 - 2*t) + (1 << 14)) >> 15;
+        axis.cell[i] = (position >> 16) - lowest;
+        axis.weight0[i] = 32768 - fade;
+        axis.weight1[i] = fade;
+        axis.delta0[i] = t;
+        axis.delta1[i] = t - 32768;
+    }
+}
+
+void renoise_world_generate_chunk_points_fixed(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int16_t* dest, int64_t dest_stride) {
+    assert(world->frequency_q16 != 0 && "ERROR: World wasn't generated with renoise_world_generate_fixed");
+    assert(world->noise == RENOISE_NOISE_PERLIN && "ERROR: The fixed-point kernel only makes Perlin noise");
+    assert(world->warp.amplitude == 0.0 && "ERROR: The fixed-point kernel can't warp");
+    uint64_t stats_start = renoise_stats_begin();
+    const int64_t chunk_size = world->chunk_size;
+    const uint32_t frequency_q16 = world->frequency_q16;
+
+    // The gradient points the chunk's samples fall between, from the cell of the first sample up to the corner
+    // past the cell of the last one
+    int64_t lowest_x = (chunk_x*chunk_size*frequency_q16) >> 16;
+    int64_t lowest_y = (chunk_y*chunk_size*frequency_q16) >> 16;
+    int64_t grid_width = ((((chunk_x + 1)*chunk_size - 1)*frequency_q16) >> 16) + 2 - lowest_x;
+    int64_t grid_height = ((((chunk_y + 1)*chunk_size - 1)*frequency_q16) >> 16) + 2 - lowest_y;
+
+    assert(grid_width <= fixed_max_grid_size(chunk_size, frequency_q16) && grid_height <= fixed_max_grid_size(chunk_size, frequency_q16));
+
+    // The gradient grid, both axes and the corner gradients of the current row, laid out in the world's scratch
+    int32_t* grid_x = world->fixed_scratch;
+    int32_t* grid_y = grid_x + grid_width*grid_height;
+    Fixed_Axis axis_x = { .cell = grid_y + grid_width*grid_height };
+    axis_x.weight0 = axis_x.cell + chunk_size;
+    axis_x.weight1 = axis_x.weight0 + chunk_size;
+    axis_x.delta0 = axis_x.weight1 + chunk_size;
+    axis_x.delta1 = axis_x.delta0 + chunk_size;
+    Fixed_Axis axis_y = { .cell = axis_x.delta1 + chunk_size };
+    axis_y.weight0 = axis_y.cell + chunk_size;
+    axis_y.weight1 = axis_y.weight0 + chunk_size;
+    axis_y.delta0 = axis_y.weight1 + chunk_size;
+    axis_y.delta1 = axis_y.delta0 + chunk_size;
+    int32_t* row = axis_y.delta1 + chunk_size;
+
+    fixed_axis_precompute(axis_x, chunk_x, chunk_size, frequency_q16, lowest_x);
+    fixed_axis_precompute(axis_y, chunk_y, chunk_size, frequency_q16, lowest_y);
+
+    // Gather the gradient points from the chunks owning them; the streams are kept for every chunk, so this works
+    // on evicted neighbours without restoring them
+    for (int64_t grid_j = 0; grid_j < grid_height; ++grid_j) {
+        int64_t grad_point_y = lowest_y + grid_j;
+        int64_t owner_y = fixed_owner_chunk(chunk_y, grad_point_y, chunk_size, frequency_q16);
+        assert(owner_y >= 0 && owner_y < world->size && "ERROR: The chunk needs its neighbours, it can't be on the edge");
+        int64_t local_y = grad_point_y - renoise_fixed_first_grad_point(owner_y, chunk_size, frequency_q16);
+        for (int64_t grid_i = 0; grid_i < grid_width; ++grid_i) {
+            int64_t grad_point_x = lowest_x + grid_i;
+            int64_t owner_x = fixed_owner_chunk(chunk_x, grad_point_x, chunk_size, frequency_q16);
+            assert(owner_x >= 0 && owner_x < world->size && "ERROR: The chunk needs its neighbours, it can't be on the edge");
+            int64_t local_x = grad_point_x - renoise_fixed_first_grad_point(owner_x, chunk_size, frequency_q16);
+            Renoise_Chunk* owner = world->chunks[renoise_world_chunk_index(world, owner_x, owner_y)];
+            int64_t index = local_x + local_y * owner->grad_point_count_x;
+            uint64_t hash = renoise_gradient_hash(world->seed, owner_x, owner_y, index, owner->grad_streams[index]);
+            grid_x[grid_i + grid_j*grid_width] = fixed_gradients[hash >> 56][0];
+            grid_y[grid_i + grid_j*grid_width] = fixed_gradients[hash >> 56][1];
+        }
+    }
+
+    int32_t* restrict top_left_x = row;
+    int32_t* restrict top_left_y = top_left_x + chunk_size;
+    int32_t* restrict top_right_x = top_left_y + chunk_size;
+    int32_t* restrict top_right_y = top_right_x + chunk_size;
+    int32_t* restrict bottom_left_x = top_right_y + chunk_size;
+    int32_t* restrict bottom_left_y = bottom_left_x + chunk_size;
+    int32_t* restrict bottom_right_x = bottom_left_y + chunk_size;
+    int32_t* restrict bottom_right_y = bottom_right_x + chunk_size;
+    int32_t gathered_cell = -1;
+    for (int64_t point_y = 0; point_y < chunk_size; ++point_y) {
+        int32_t cell_y = axis_y.cell[point_y];
+        if (cell_y != gathered_cell) {
+            // The corner gradients only change when the row crosses into the next row of cells
+            const int32_t* top = grid_x + cell_y*grid_width;
+            const int32_t* bottom = top + grid_width;
+            for (int64_t point_x = 0; point_x < chunk_size; ++point_x) {
+                int32_t cell_x = axis_x.cell[point_x];
+                top_left_x[point_x] = top[cell_x];
+                top_right_x[point_x] = top[cell_x + 1];
+                bottom_left_x[point_x] = bottom[cell_x];
+                bottom_right_x[point_x] = bottom[cell_x + 1];
+                top_left_y[point_x] = top[cell_x + grid_width*grid_height];
+                top_right_y[point_x] = top[cell_x + 1 + grid_width*grid_height];
+                bottom_left_y[point_x] = bottom[cell_x + grid_width*grid_height];
+                bottom_right_y[point_x] = bottom[cell_x + 1 + grid_width*grid_height];
+            }
+            gathered_cell = cell_y;
+        }
+
+        const int32_t delta_y0 = axis_y.delta0[point_y];
+        const int32_t delta_y1 = axis_y.delta1[point_y];
+        const int32_t weight_y0 = axis_y.weight0[point_y];
+        const int32_t weight_y1 = axis_y.weight1[point_y];
+        int16_t* restrict out = dest + point_y*dest_stride;
+        // Branch-free and int32 only, so it vectorises: Q14 gradients times Q15 distances, back to Q15 dot products,
+        // then blended with the Q15 fade weights. Every shift rounds to nearest.
+        for (int64_t point_x = 0; point_x < chunk_size; ++point_x) {
+            int32_t dot_top_left = (top_left_x[point_x]*axis_x.delta0[point_x] + top_left_y[point_x]*delta_y0 + (1 << 13)) >> 14;
+            int32_t dot_top_right = (top_right_x[point_x]*axis_x.delta1[point_x] + top_right_y[point_x]*delta_y0 + (1 << 13)) >> 14;
+            int32_t dot_bottom_left = (bottom_left_x[point_x]*axis_x.delta0[point_x] + bottom_left_y[point_x]*delta_y1 + (1 << 13)) >> 14;
+            int32_t dot_bottom_right = (bottom_right_x[point_x]*axis_x.delta1[point_x] + bottom_right_y[point_x]*delta_y1 + (1 << 13)) >> 14;
+            int32_t top = (dot_top_left*axis_x.weight0[point_x] + dot_top_right*axis_x.weight1[point_x] + (1 << 14)) >> 15;
+            int32_t bottom = (dot_bottom_left*axis_x.weight0[point_x] + dot_bottom_right*axis_x.weight1[point_x] + (1 << 14)) >> 15;
+            int32_t value = (top*weight_y0 + bottom*weight_y1 + (1 << 14)) >> 15;
+            value = value < -32768 ? -32768 : value;
+            value = value > 32767 ? 32767 : value;
+            out[point_x] = value;
+        }
+    }
+
+    if (stats_start != 0) renoise_stats_count(RENOISE_COUNTER_SAMPLES_EVALUATED, chunk_size*chunk_size);
+    renoise_stats_end(RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_FIXED, stats_start);
+}
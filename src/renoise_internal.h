@@ -0,0 +1,147 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Functions shared between the library's source files; not part of the public API.
+#pragma once
+#include "renoise.h"
+#include <stdatomic.h>
+#include <math.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Where the first gradient point of a chunk lies along one axis, and how many gradient points the chunk owns along it
+double renoise_grad_offset(int64_t chunk_coord, int64_t chunk_size, double frequency);
+int64_t renoise_grad_point_count(double grad_offset, int64_t chunk_size, double frequency);
+uint64_t renoise_gradient_hash(uint64_t seed, int64_t chunk_x, int64_t chunk_y, int64_t index, uint32_t stream);
+
+// The index of the lowest set bit, `bits` can't be 0
+static inline int64_t renoise_lowest_set_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    int64_t index = 0;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        index += 1;
+    }
+    return index;
+#endif
+}
+
+// The hash the gradient points of 2D and 3D chunks are rolled with
+static inline uint64_t renoise_splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+    return x ^ (x >> 31);
+}
+
+// The falloff of a gradient point along one axis, `t` being the distance to it in gradient point units
+static inline double renoise_perlin_function(double t) {
+    t = fabs(t);
+    if (t >= 1.0) return 0.0;
+    return 1 - (3 - 2*t) * t*t;
+}
+// Rolls gradient point `index` of a chunk with the generator of its world (floating-point or fixed table)
+Renoise_Vector renoise_chunk_gradient_point(Renoise_Chunk* chunk, int64_t index, uint32_t stream);
+
+// Fixed-point worlds, see renoise_fixed.c
+// The global index of the first gradient point of chunk `chunk_coord` on a fixed-point lattice
+int64_t renoise_fixed_first_grad_point(int64_t chunk_coord, int64_t chunk_size, uint32_t frequency_q16);
+// How many int32_t the fixed-point kernel needs as scratch for any chunk of a world, see `world->fixed_scratch`
+int64_t renoise_fixed_scratch_size(int64_t chunk_size, uint32_t frequency_q16);
+// Computes the points of a world chunk from the gradient points, (re)allocating them if the chunk was evicted
+void renoise_world_fill_chunk_points(Renoise_World* world, Renoise_Chunk* chunk);
+// Brings back the gradient points of an evicted chunk
+void renoise_world_restore_grad_points(Renoise_World* world, Renoise_Chunk* chunk);
+// Brings back the points of an evicted chunk like renoise_world_get_chunk, but for the library's own accesses: it
+// doesn't count in `world->cache` or the stats, which are there to size the memory budget against the caller's use
+Renoise_Chunk* renoise_world_load_chunk(Renoise_World* world, Renoise_Chunk* chunk);
+// Marks a chunk as the most recently used one
+void renoise_world_touch_chunk(Renoise_World* world, Renoise_Chunk* chunk);
+// Evicts least recently used chunks until the world fits in its memory budget again
+void renoise_world_enforce_memory_budget(Renoise_World* world);
+// Gives a chunk a new version and marks it dirty, see renoise_world_drain_changes
+void renoise_world_mark_chunk_changed(Renoise_World* world, Renoise_Chunk* chunk);
+// The published points of a world, see renoise_snapshot.c
+Renoise_Published* renoise_published_create(int64_t world_size, int64_t chunk_size);
+void renoise_published_free(Renoise_Published* published);
+// Allocates a plane of points, backed by huge pages where the OS allows it
+double* renoise_plane_alloc(int64_t size);
+void renoise_plane_free(double* plane);
+// The size of everything that can be evicted from a chunk
+int64_t renoise_chunk_payload_size(Renoise_Chunk* chunk);
+
+// Round and saturate an already scaled and biased sample
+static inline uint8_t renoise_quantize_uint8(double value) {
+    value = round(value);
+    if (value <= 0.0) return 0;
+    if (value >= UINT8_MAX) return UINT8_MAX;
+    return (uint8_t) value;
+}
+
+static inline int16_t renoise_quantize_int16(double value) {
+    value = round(value);
+    if (value <= INT16_MIN) return INT16_MIN;
+    if (value >= INT16_MAX) return INT16_MAX;
+    return (int16_t) value;
+}
+
+typedef struct {
+    const Renoise_Stream_Runs* runs;
+    int64_t run;
+    uint32_t offset;
+} Renoise_Stream_Cursor;
+
+void renoise_stream_runs_push(Renoise_Stream_Runs* runs, uint32_t stream);
+uint32_t renoise_stream_cursor_next(Renoise_Stream_Cursor* cursor);
+// Starts a new journal entry, dropping everything that could still be redone, and returns where to record the previous streams
+Renoise_Stream_Runs* renoise_journal_record(Renoise_Journal* journal, Renoise_Operation operation);
+// Rolls the gradient points an operation touches with the operation's stream, reporting their previous streams to
+// `record` if it isn't NULL, or rolls them back to the streams from `restore` if it isn't NULL.
+// The gradient points are always visited in the same order.
+void renoise_world_roll_grad_points(Renoise_World* world, Renoise_Operation operation, Renoise_Stream_Runs* record, Renoise_Stream_Cursor* restore);
+void renoise_world_regenerate_operation_points(Renoise_World* world, Renoise_Operation operation);
+// The inner chunks whose points an operation affects, as a rectangle of chunks (empty when there are none)
+void renoise_world_operation_chunks(Renoise_World* world, Renoise_Operation operation, int64_t* start_x, int64_t* start_y, int64_t* end_x, int64_t* end_y);
+// Everything of renoise_world_apply_operation but recomputing the points
+void renoise_world_roll_operation(Renoise_World* world, Renoise_Operation operation);
+
+typedef enum {
+    RENOISE_COUNTER_CHUNKS_GENERATED,
+    RENOISE_COUNTER_SAMPLES_EVALUATED,
+    RENOISE_COUNTER_GRAD_POINTS_ROLLED,
+    RENOISE_COUNTER_NEIGHBOUR_HOPS,
+    RENOISE_COUNTER_COUNT,
+} Renoise_Counter;
+
+extern atomic_bool renoise_stats_enabled;
+
+static inline bool renoise_stats_on() {
+    return atomic_load_explicit(&renoise_stats_enabled, memory_order_relaxed);
+}
+
+void renoise_stats_count(Renoise_Counter counter, uint64_t amount);
+// Returns the start time to pass to renoise_stats_end, or 0 when statistics are off
+uint64_t renoise_stats_begin();
+// A monotonic clock, the one the statistics use
+uint64_t renoise_now_ns();
+void renoise_stats_end(Renoise_Stats_Function function, uint64_t start);
@@ -0,0 +1,126 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <string.h>
+
+// The journal doesn't store gradient points or points: an operation is its region plus the RNG stream it rolled
+// with, and undoing it only needs the streams the gradient points had before, which are mostly runs of the same value.
+
+void renoise_stream_runs_push(Renoise_Stream_Runs* runs, uint32_t stream) {
+    if (runs->count > 0) {
+        Renoise_Stream_Run* last = &runs->items[runs->count - 1];
+        if (last->stream == stream && last->count < UINT32_MAX) {
+            last->count += 1;
+            return;
+        }
+    }
+    if (runs->count >= runs->capacity) {
+        runs->capacity = runs->capacity == 0 ? 8 : runs->capacity * 2;
+        runs->items = realloc(runs->items, runs->capacity * sizeof(*runs->items));
+        assert(runs->items != NULL && "ERROR: Out of memory; buy more RAM.");
+    }
+    runs->items[runs->count++] = (Renoise_Stream_Run) {
+        .count = 1,
+        .stream = stream,
+    };
+}
+
+uint32_t renoise_stream_cursor_next(Renoise_Stream_Cursor* cursor) {
+    assert(cursor->run < cursor->runs->count && "ERROR: Journal entry doesn't match the world");
+    Renoise_Stream_Run run = cursor->runs->items[cursor->run];
+    cursor->offset += 1;
+    if (cursor->offset >= run.count) {
+        cursor->run += 1;
+        cursor->offset = 0;
+    }
+    return run.stream;
+}
+
+Renoise_Journal* renoise_journal_create() {
+    Renoise_Journal* journal = malloc(sizeof(Renoise_Journal));
+    assert(journal != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(journal, 0, sizeof(Renoise_Journal));
+    return journal;
+}
+
+static void journal_truncate(Renoise_Journal* journal, int64_t count) {
+    for (int64_t i = count; i < journal->count; ++i) {
+        free(journal->entries[i].previous_streams.items);
+    }
+    journal->count = count;
+    if (journal->position > count) journal->position = count;
+}
+
+void renoise_journal_clear(Renoise_Journal* journal) {
+    journal_truncate(journal, 0);
+}
+
+void renoise_journal_free(Renoise_Journal* journal) {
+    journal_truncate(journal, 0);
+    free(journal->entries);
+    free(journal);
+}
+
+Renoise_Stream_Runs* renoise_journal_record(Renoise_Journal* journal, Renoise_Operation operation) {
+    // A new operation makes the undone ones impossible to redo
+    journal_truncate(journal, journal->position);
+    if (journal->count >= journal->capacity) {
+        journal->capacity = journal->capacity == 0 ? 16 : journal->capacity * 2;
+        journal->entries = realloc(journal->entries, journal->capacity * sizeof(*journal->entries));
+        assert(journal->entries != NULL && "ERROR: Out of memory; buy more RAM.");
+    }
+    Renoise_Journal_Entry* entry = &journal->entries[journal->count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->operation = operation;
+    journal->position = journal->count;
+    return &entry->previous_streams;
+}
+
+bool renoise_world_undo(Renoise_World* world) {
+    Renoise_Journal* journal = world->journal;
+    if (journal == NULL || journal->position == 0) return false;
+
+    Renoise_Journal_Entry* entry = &journal->entries[--journal->position];
+    Renoise_Stream_Cursor cursor = { .runs = &entry->previous_streams };
+    uint64_t stats_start = renoise_stats_begin();
+    renoise_world_roll_grad_points(world, entry->operation, NULL, &cursor);
+    assert(cursor.run == entry->previous_streams.count && "ERROR: Journal entry doesn't match the world");
+    renoise_world_regenerate_operation_points(world, entry->operation);
+    renoise_stats_end(RENOISE_STATS_WORLD_UNDO, stats_start);
+    return true;
+}
+
+bool renoise_world_redo(Renoise_World* world) {
+    Renoise_Journal* journal = world->journal;
+    if (journal == NULL || journal->position >= journal->count) return false;
+
+    // Rolling with the same stream again gives the same gradient points; the previous streams are still valid
+    Renoise_Journal_Entry* entry = &journal->entries[journal->position++];
+    uint64_t stats_start = renoise_stats_begin();
+    renoise_world_roll_grad_points(world, entry->operation, NULL, NULL);
+    renoise_world_regenerate_operation_points(world, entry->operation);
+    renoise_stats_end(RENOISE_STATS_WORLD_REDO, stats_start);
+    return true;
+}
+
+void renoise_world_replay(Renoise_World* world, const Renoise_Journal* journal) {
+    assert(world->journal != journal && "ERROR: Can't replay a journal onto the world it's recording");
+    for (int64_t i = 0; i < journal->position; ++i) {
+        renoise_world_apply_operation(world, journal->entries[i].operation);
+    }
+}
@@ -0,0 +1,229 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The part of a chunk that lies in a region, in world sample coordinates
+typedef struct {
+    int64_t start_x;
+    int64_t start_y;
+    int64_t end_x;
+    int64_t end_y;
+} Chunk_Overlap;
+
+static Chunk_Overlap chunk_overlap(Renoise_Chunk* chunk, Renoise_Rect region) {
+    int64_t chunk_start_x = chunk->x * chunk->size;
+    int64_t chunk_start_y = chunk->y * chunk->size;
+    int64_t chunk_end_x = chunk_start_x + chunk->size;
+    int64_t chunk_end_y = chunk_start_y + chunk->size;
+    return (Chunk_Overlap) {
+        .start_x = chunk_start_x > region.x ? chunk_start_x : region.x,
+        .start_y = chunk_start_y > region.y ? chunk_start_y : region.y,
+        .end_x = chunk_end_x < region.x + region.width ? chunk_end_x : region.x + region.width,
+        .end_y = chunk_end_y < region.y + region.height ? chunk_end_y : region.y + region.height,
+    };
+}
+
+typedef void (*Region_Chunk_Function)(Renoise_Chunk* chunk, Renoise_Rect region, void* user);
+
+// Calls `function` for every chunk that overlaps `region`, with the chunk's points available
+static void world_for_each_region_chunk(Renoise_World* world, Renoise_Rect region, Region_Chunk_Function function, void* user) {
+    assert(region.x >= 0 && region.y >= 0);
+    assert(region.x + region.width <= world->size * world->chunk_size);
+    assert(region.y + region.height <= world->size * world->chunk_size);
+    if (region.width <= 0 || region.height <= 0) return;
+
+    int64_t first_chunk_x = region.x / world->chunk_size;
+    int64_t first_chunk_y = region.y / world->chunk_size;
+    int64_t last_chunk_x = (region.x + region.width - 1) / world->chunk_size;
+    int64_t last_chunk_y = (region.y + region.height - 1) / world->chunk_size;
+
+    if (world->memory_budget != 0) {
+        // Getting a chunk may evict another one, so only one chunk can be used at a time
+        for (int64_t chunk_y = first_chunk_y; chunk_y <= last_chunk_y; ++chunk_y) {
+            for (int64_t chunk_x = first_chunk_x; chunk_x <= last_chunk_x; ++chunk_x) {
+                function(renoise_world_get_chunk(world, chunk_x, chunk_y), region, user);
+            }
+        }
+        return;
+    }
+
+    // Make sure every chunk has its points first; after that the chunks are only read, which can happen in parallel
+    for (int64_t chunk_y = first_chunk_y; chunk_y <= last_chunk_y; ++chunk_y) {
+        for (int64_t chunk_x = first_chunk_x; chunk_x <= last_chunk_x; ++chunk_x) {
+            renoise_world_get_chunk(world, chunk_x, chunk_y);
+        }
+    }
+    int64_t chunk_count_x = last_chunk_x - first_chunk_x + 1;
+    int64_t chunk_count = chunk_count_x * (last_chunk_y - first_chunk_y + 1);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (chunk_count >= 16)
+#endif
+    for (int64_t i = 0; i < chunk_count; ++i) {
+        int64_t chunk_x = first_chunk_x + i % chunk_count_x;
+        int64_t chunk_y = first_chunk_y + i / chunk_count_x;
+        function(world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)], region, user);
+    }
+}
+
+Renoise_Palette renoise_palette_grayscale() {
+    Renoise_Palette palette;
+    for (int i = 0; i < 256; ++i) {
+        palette.colors[i][0] = i;
+        palette.colors[i][1] = i;
+        palette.colors[i][2] = i;
+        palette.colors[i][3] = 255;
+    }
+    return palette;
+}
+
+typedef struct {
+    uint8_t* rgba;
+    int64_t stride;
+    // The palette as one 32-bit word per colour, so writing a pixel is a single store
+    uint32_t colors[256];
+} Rasterize_Target;
+
+// Rasterizes the part of one chunk that lies in `region`. The loop is branch-free so it gets vectorised:
+// clamping before adding 0.5 and truncating is the same as rounding and then saturating.
+static void rasterize_chunk(Renoise_Chunk* chunk, Renoise_Rect region, void* user) {
+    const Rasterize_Target* target = user;
+    Renoise_Quantize quantize = renoise_quantize_default(RENOISE_QUANTIZE_UINT8);
+    Chunk_Overlap overlap = chunk_overlap(chunk, region);
+    for (int64_t y = overlap.start_y; y < overlap.end_y; ++y) {
+        const double* restrict points = &chunk->points[(overlap.start_x - chunk->x * chunk->size) + (y - chunk->y * chunk->size) * chunk->points_stride];
+        uint32_t* restrict pixels = (uint32_t*) (target->rgba + (y - region.y) * target->stride) + (overlap.start_x - region.x);
+        for (int64_t x = 0; x < overlap.end_x - overlap.start_x; ++x) {
+            double value = points[x] * quantize.scale + quantize.bias;
+            value = value < 0.0 ? 0.0 : value;
+            value = value > 255.0 ? 255.0 : value;
+            pixels[x] = target->colors[(uint8_t) (value + 0.5)];
+        }
+    }
+}
+
+void renoise_world_rasterize(Renoise_World* world, Renoise_Rect region, uint8_t* rgba, int64_t stride, const Renoise_Palette* palette) {
+    assert(stride % sizeof(uint32_t) == 0 && "ERROR: Rows should be aligned to whole pixels");
+    Rasterize_Target target = { .rgba = rgba, .stride = stride };
+    Renoise_Palette grayscale;
+    if (palette == NULL) {
+        grayscale = renoise_palette_grayscale();
+        palette = &grayscale;
+    }
+    memcpy(target.colors, palette->colors, sizeof(target.colors));
+    world_for_each_region_chunk(world, region, rasterize_chunk, &target);
+}
+
+typedef struct {
+    void* dest;
+    int64_t dest_stride;
+} Read_Target;
+
+// Rows of a chunk are contiguous, so reading doubles is one copy per row
+static void read_chunk_double(Renoise_Chunk* chunk, Renoise_Rect region, void* user) {
+    const Read_Target* target = user;
+    Chunk_Overlap overlap = chunk_overlap(chunk, region);
+    for (int64_t y = overlap.start_y; y < overlap.end_y; ++y) {
+        memcpy(
+            (double*) target->dest + (overlap.start_x - region.x) + (y - region.y) * target->dest_stride,
+            &chunk->points[(overlap.start_x - chunk->x * chunk->size) + (y - chunk->y * chunk->size) * chunk->points_stride],
+            (overlap.end_x - overlap.start_x) * sizeof(double)
+        );
+    }
+}
+
+static void read_chunk_float(Renoise_Chunk* chunk, Renoise_Rect region, void* user) {
+    const Read_Target* target = user;
+    Chunk_Overlap overlap = chunk_overlap(chunk, region);
+    for (int64_t y = overlap.start_y; y < overlap.end_y; ++y) {
+        const double* restrict points = &chunk->points[(overlap.start_x - chunk->x * chunk->size) + (y - chunk->y * chunk->size) * chunk->points_stride];
+        float* restrict dest = (float*) target->dest + (overlap.start_x - region.x) + (y - region.y) * target->dest_stride;
+        for (int64_t x = 0; x < overlap.end_x - overlap.start_x; ++x) {
+            dest[x] = (float) points[x];
+        }
+    }
+}
+
+static void read_chunk_int16(Renoise_Chunk* chunk, Renoise_Rect region, void* user) {
+    const Read_Target* target = user;
+    Renoise_Quantize quantize = renoise_quantize_default(RENOISE_QUANTIZE_INT16);
+    Chunk_Overlap overlap = chunk_overlap(chunk, region);
+    for (int64_t y = overlap.start_y; y < overlap.end_y; ++y) {
+        const double* restrict points = &chunk->points[(overlap.start_x - chunk->x * chunk->size) + (y - chunk->y * chunk->size) * chunk->points_stride];
+        int16_t* restrict dest = (int16_t*) target->dest + (overlap.start_x - region.x) + (y - region.y) * target->dest_stride;
+        for (int64_t x = 0; x < overlap.end_x - overlap.start_x; ++x) {
+            dest[x] = renoise_quantize_int16(points[x] * quantize.scale + quantize.bias);
+        }
+    }
+}
+
+void renoise_world_read_region(Renoise_World* world, Renoise_Rect region, double* dest, int64_t dest_stride) {
+    if (world->plane != NULL && region.width > 0) {
+        // The rows of a plane span the whole world, and its chunks always have their points
+        assert(region.x >= 0 && region.y >= 0);
+        assert(region.x + region.width <= world->plane_stride);
+        assert(region.y + region.height <= world->plane_stride);
+        for (int64_t y = 0; y < region.height; ++y) {
+            memcpy(&dest[y * dest_stride], &world->plane[region.x + (region.y + y) * world->plane_stride], region.width * sizeof(double));
+        }
+        return;
+    }
+    world_for_each_region_chunk(world, region, read_chunk_double, &(Read_Target) { dest, dest_stride });
+}
+
+void renoise_world_read_region_float(Renoise_World* world, Renoise_Rect region, float* dest, int64_t dest_stride) {
+    world_for_each_region_chunk(world, region, read_chunk_float, &(Read_Target) { dest, dest_stride });
+}
+
+void renoise_world_read_region_int16(Renoise_World* world, Renoise_Rect region, int16_t* dest, int64_t dest_stride) {
+    world_for_each_region_chunk(world, region, read_chunk_int16, &(Read_Target) { dest, dest_stride });
+}
+
+void renoise_world_read_region_derivatives(Renoise_World* world, Renoise_Rect region, double* dest_dx, double* dest_dy, int64_t dest_stride) {
+    assert(region.x >= 0 && region.y >= 0);
+    assert(region.x + region.width <= world->size * world->chunk_size);
+    assert(region.y + region.height <= world->size * world->chunk_size);
+    if (region.width <= 0 || region.height <= 0) return;
+
+    int64_t chunk_size = world->chunk_size;
+    double* chunk_dx = malloc(2 * chunk_size*chunk_size * sizeof(double));
+    assert(chunk_dx != NULL && "ERROR: Out of memory; buy more RAM.");
+    double* chunk_dy = chunk_dx + chunk_size*chunk_size;
+    for (int64_t chunk_y = region.y / chunk_size; chunk_y <= (region.y + region.height - 1) / chunk_size; ++chunk_y) {
+        for (int64_t chunk_x = region.x / chunk_size; chunk_x <= (region.x + region.width - 1) / chunk_size; ++chunk_x) {
+            Renoise_Chunk* chunk = world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)];
+            bool edge = chunk_x < 1 || chunk_x >= world->size - 1 || chunk_y < 1 || chunk_y >= world->size - 1;
+            if (!edge) renoise_world_generate_chunk_points_derivatives(world, chunk_x, chunk_y, NULL, chunk_dx, chunk_dy, chunk_size);
+            Chunk_Overlap overlap = chunk_overlap(chunk, region);
+            for (int64_t y = overlap.start_y; y < overlap.end_y; ++y) {
+                int64_t dest_index = (overlap.start_x - region.x) + (y - region.y) * dest_stride;
+                int64_t chunk_index = (overlap.start_x - chunk_x * chunk_size) + (y - chunk_y * chunk_size) * chunk_size;
+                size_t row_size = (overlap.end_x - overlap.start_x) * sizeof(double);
+                if (edge) {
+                    memset(&dest_dx[dest_index], 0, row_size);
+                    memset(&dest_dy[dest_index], 0, row_size);
+                } else {
+                    memcpy(&dest_dx[dest_index], &chunk_dx[chunk_index], row_size);
+                    memcpy(&dest_dy[dest_index], &chunk_dy[chunk_index], row_size);
+                }
+            }
+        }
+    }
+    free(chunk_dx);
+}
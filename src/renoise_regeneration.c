@@ -0,0 +1,173 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <string.h>
+
+Renoise_Regeneration renoise_world_begin_operation(Renoise_World* world, Renoise_Operation operation) {
+    renoise_world_roll_operation(world, operation);
+
+    int64_t start_x, start_y, end_x, end_y;
+    renoise_world_operation_chunks(world, operation, &start_x, &start_y, &end_x, &end_y);
+    return (Renoise_Regeneration) {
+        .world = world,
+        .operation = operation,
+        .start_x = start_x,
+        .start_y = start_y,
+        .width = end_x - start_x,
+        .height = end_y - start_y,
+    };
+}
+
+Renoise_Regeneration renoise_world_begin_regenerate_rect(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height) {
+    return renoise_world_begin_operation(world, (Renoise_Operation) {
+        .kind = RENOISE_OPERATION_REGENERATE_RECT,
+        .chunk_x = chunk_x,
+        .chunk_y = chunk_y,
+        .width = width,
+        .height = height,
+        .stream = world->rng_stream + 1,
+    });
+}
+
+Renoise_Regeneration renoise_world_begin_regenerate_full_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    return renoise_world_begin_operation(world, (Renoise_Operation) {
+        .kind = RENOISE_OPERATION_REGENERATE_FULL_CHUNK,
+        .chunk_x = chunk_x,
+        .chunk_y = chunk_y,
+        .width = 1,
+        .height = 1,
+        .stream = world->rng_stream + 1,
+    });
+}
+
+bool renoise_regeneration_step(Renoise_Regeneration* regeneration, Renoise_Work_Budget budget) {
+    uint64_t stats_start = renoise_stats_begin();
+    Renoise_World* world = regeneration->world;
+    int64_t chunk_count = regeneration->width * regeneration->height;
+    int64_t chunk_samples = world->chunk_size * world->chunk_size;
+    // Only read the clock when there's a time budget
+    uint64_t start_ns = budget.time_ns != 0 ? renoise_now_ns() : 0;
+
+    int64_t samples = 0;
+    while (regeneration->chunks_done < chunk_count) {
+        if (samples > 0) {
+            if (budget.samples != 0 && samples + chunk_samples > budget.samples) break;
+            if (budget.time_ns != 0 && renoise_now_ns() - start_ns >= budget.time_ns) break;
+        }
+        int64_t chunk_x = regeneration->start_x + regeneration->chunks_done % regeneration->width;
+        int64_t chunk_y = regeneration->start_y + regeneration->chunks_done / regeneration->width;
+        renoise_world_generate_chunk_points(world, chunk_x, chunk_y);
+        regeneration->chunks_done += 1;
+        samples += chunk_samples;
+    }
+
+    renoise_stats_end(RENOISE_STATS_REGENERATION_STEP, stats_start);
+    return regeneration->chunks_done >= chunk_count;
+}
+
+double renoise_regeneration_progress(const Renoise_Regeneration* regeneration) {
+    int64_t chunk_count = regeneration->width * regeneration->height;
+    if (chunk_count == 0) return 1.0;
+    return (double) regeneration->chunks_done / chunk_count;
+}
+
+// Copies the points of the crossfade's chunks to `points`
+static void crossfade_copy_points(Renoise_Crossfade* crossfade, double* points) {
+    Renoise_World* world = crossfade->world;
+    int64_t chunk_samples = world->chunk_size * world->chunk_size;
+    for (int64_t i = 0; i < crossfade->width * crossfade->height; ++i) {
+        int64_t index = renoise_world_chunk_index(world, crossfade->start_x + i % crossfade->width, crossfade->start_y + i / crossfade->width);
+        Renoise_Chunk* chunk = renoise_world_load_chunk(world, world->chunks[index]);
+        for (int64_t y = 0; y < chunk->size; ++y) {
+            memcpy(&points[i*chunk_samples + y*chunk->size], &chunk->points[y * chunk->points_stride], chunk->size * sizeof(*points));
+        }
+    }
+}
+
+Renoise_Crossfade* renoise_world_begin_crossfade(Renoise_World* world, Renoise_Operation operation) {
+    Renoise_Crossfade* crossfade = malloc(sizeof(Renoise_Crossfade));
+    assert(crossfade != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(crossfade, 0, sizeof(Renoise_Crossfade));
+    crossfade->world = world;
+
+    int64_t start_x, start_y, end_x, end_y;
+    renoise_world_operation_chunks(world, operation, &start_x, &start_y, &end_x, &end_y);
+    crossfade->start_x = start_x;
+    crossfade->start_y = start_y;
+    crossfade->width = end_x - start_x;
+    crossfade->height = end_y - start_y;
+    int64_t sample_count = crossfade->width * crossfade->height * world->chunk_size*world->chunk_size;
+    crossfade->old_points = malloc(sample_count * sizeof(*crossfade->old_points));
+    crossfade->new_points = malloc(sample_count * sizeof(*crossfade->new_points));
+    assert(crossfade->old_points != NULL && crossfade->new_points != NULL && "ERROR: Out of memory; buy more RAM.");
+
+    crossfade_copy_points(crossfade, crossfade->old_points);
+    renoise_world_apply_operation(world, operation);
+    crossfade_copy_points(crossfade, crossfade->new_points);
+    renoise_crossfade_set(crossfade, 0.0);
+    return crossfade;
+}
+
+Renoise_Crossfade* renoise_world_crossfade_rect(Renoise_World* world, int64_t chunk_x, int64_t chunk_y, int64_t width, int64_t height) {
+    return renoise_world_begin_crossfade(world, (Renoise_Operation) {
+        .kind = RENOISE_OPERATION_REGENERATE_RECT,
+        .chunk_x = chunk_x,
+        .chunk_y = chunk_y,
+        .width = width,
+        .height = height,
+        .stream = world->rng_stream + 1,
+    });
+}
+
+Renoise_Crossfade* renoise_world_crossfade_full_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    return renoise_world_begin_crossfade(world, (Renoise_Operation) {
+        .kind = RENOISE_OPERATION_REGENERATE_FULL_CHUNK,
+        .chunk_x = chunk_x,
+        .chunk_y = chunk_y,
+        .width = 1,
+        .height = 1,
+        .stream = world->rng_stream + 1,
+    });
+}
+
+void renoise_crossfade_set(Renoise_Crossfade* crossfade, double t) {
+    Renoise_World* world = crossfade->world;
+    int64_t chunk_samples = world->chunk_size * world->chunk_size;
+    crossfade->t = t;
+    for (int64_t i = 0; i < crossfade->width * crossfade->height; ++i) {
+        int64_t index = renoise_world_chunk_index(world, crossfade->start_x + i % crossfade->width, crossfade->start_y + i / crossfade->width);
+        Renoise_Chunk* chunk = renoise_world_load_chunk(world, world->chunks[index]);
+        const double* old_points = &crossfade->old_points[i*chunk_samples];
+        const double* new_points = &crossfade->new_points[i*chunk_samples];
+        for (int64_t y = 0; y < chunk->size; ++y) {
+            double* points = &chunk->points[y * chunk->points_stride];
+            for (int64_t x = 0; x < chunk->size; ++x) {
+                // Not old + (new - old) * t, so both ends are exact
+                points[x] = (1.0 - t) * old_points[x + y*chunk->size] + t * new_points[x + y*chunk->size];
+            }
+        }
+        renoise_world_mark_chunk_changed(world, chunk);
+    }
+}
+
+void renoise_crossfade_free(Renoise_Crossfade* crossfade) {
+    free(crossfade->old_points);
+    free(crossfade->new_points);
+    free(crossfade);
+}
@@ -0,0 +1,190 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <string.h>
+
+// The points of one chunk as of one version; never written to once published, freed by whoever drops the last reference
+typedef struct {
+    atomic_int_fast64_t references;
+    uint64_t version;
+    double points[];
+} Published_Points;
+
+// One row of chunks; a publish that changes nothing in a row shares it with the previous table
+typedef struct {
+    atomic_int_fast64_t references;
+    Published_Points* chunks[];
+} Published_Row;
+
+// Everything one publish made visible. Never changed once published: a snapshot is one reference to a table, and it
+// gets freed when the world and the last snapshot of it let go.
+typedef struct {
+    Renoise_Snapshot snapshot;
+    atomic_int_fast64_t references;
+    // Row by row, whatever the world's chunk order; NULL for rows of which no chunk got published yet
+    Published_Row* rows[];
+} Published_Table;
+
+// The table readers see. Readers only load the pointer and reference the table, so the writer can swap it with one
+// exchange; it only has to wait for readers that loaded the old pointer to finish referencing it before it lets go of
+// it. Readers count themselves in the slot of the epoch they started in, and the writer starts a new epoch after the
+// swap, so it only ever waits for the few instructions a reader spends between loading the pointer and referencing it.
+struct Renoise_Published {
+    _Atomic(Published_Table*) table;
+    atomic_uint_fast64_t epoch;
+    atomic_int_fast64_t readers[2];
+};
+
+static void points_release(Published_Points* points) {
+    if (points != NULL && atomic_fetch_sub_explicit(&points->references, 1, memory_order_acq_rel) == 1) {
+        free(points);
+    }
+}
+
+static void row_release(Published_Row* row, int64_t size) {
+    if (row != NULL && atomic_fetch_sub_explicit(&row->references, 1, memory_order_acq_rel) == 1) {
+        for (int64_t x = 0; x < size; ++x) points_release(row->chunks[x]);
+        free(row);
+    }
+}
+
+static void table_release(Published_Table* table) {
+    if (atomic_fetch_sub_explicit(&table->references, 1, memory_order_acq_rel) == 1) {
+        for (int64_t y = 0; y < table->snapshot.size; ++y) row_release(table->rows[y], table->snapshot.size);
+        free(table);
+    }
+}
+
+static Published_Table* table_create(int64_t size, int64_t chunk_size, uint64_t version) {
+    Published_Table* table = malloc(sizeof(Published_Table) + size * sizeof(Published_Row*));
+    assert(table != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(table, 0, sizeof(Published_Table) + size * sizeof(Published_Row*));
+    table->snapshot.size = size;
+    table->snapshot.chunk_size = chunk_size;
+    table->snapshot.version = version;
+    atomic_init(&table->references, 1);
+    return table;
+}
+
+// A row the writer can change, starting out with the same points as `shared`
+static Published_Row* row_copy(Published_Row* shared, int64_t size) {
+    Published_Row* row = malloc(sizeof(Published_Row) + size * sizeof(Published_Points*));
+    assert(row != NULL && "ERROR: Out of memory; buy more RAM.");
+    atomic_init(&row->references, 1);
+    for (int64_t x = 0; x < size; ++x) {
+        row->chunks[x] = shared != NULL ? shared->chunks[x] : NULL;
+        if (row->chunks[x] != NULL) atomic_fetch_add_explicit(&row->chunks[x]->references, 1, memory_order_relaxed);
+    }
+    return row;
+}
+
+Renoise_Published* renoise_published_create(int64_t world_size, int64_t chunk_size) {
+    Renoise_Published* published = malloc(sizeof(Renoise_Published));
+    assert(published != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(published, 0, sizeof(Renoise_Published));
+    atomic_init(&published->table, table_create(world_size, chunk_size, 0));
+    atomic_init(&published->epoch, 0);
+    atomic_init(&published->readers[0], 0);
+    atomic_init(&published->readers[1], 0);
+    return published;
+}
+
+void renoise_published_free(Renoise_Published* published) {
+    // Snapshots keep their own references, so they outlive the world
+    table_release(atomic_load(&published->table));
+    free(published);
+}
+
+void renoise_world_publish(Renoise_World* world) {
+    Renoise_Published* published = world->published;
+    // Only the writer swaps tables, so the current one can't go away under it
+    Published_Table* old = atomic_load_explicit(&published->table, memory_order_relaxed);
+    Published_Table* table = table_create(world->size, world->chunk_size, world->version);
+    int64_t point_count = world->chunk_size*world->chunk_size;
+
+    // Only the chunks that changed since the last publish get copied, so evicted chunks that didn't change stay evicted
+    for (int64_t word = 0; word < (world->size*world->size + 63) / 64; ++word) {
+        uint64_t bits = world->unpublished_chunks[word];
+        world->unpublished_chunks[word] = 0;
+        while (bits != 0) {
+            int64_t slot = word * 64 + renoise_lowest_set_bit(bits);
+            bits &= bits - 1;
+            int64_t x = slot % world->size;
+            int64_t y = slot / world->size;
+            if (table->rows[y] == NULL) table->rows[y] = row_copy(old->rows[y], world->size);
+
+            Renoise_Chunk* chunk = renoise_world_load_chunk(world, world->chunks[renoise_world_chunk_index(world, x, y)]);
+            Published_Points* points = malloc(sizeof(Published_Points) + point_count * sizeof(double));
+            assert(points != NULL && "ERROR: Out of memory; buy more RAM.");
+            atomic_init(&points->references, 1);
+            points->version = chunk->version;
+            for (int64_t row = 0; row < chunk->size; ++row) {
+                memcpy(&points->points[row * chunk->size], &chunk->points[row * chunk->points_stride], chunk->size * sizeof(double));
+            }
+            points_release(table->rows[y]->chunks[x]);
+            table->rows[y]->chunks[x] = points;
+        }
+    }
+    for (int64_t y = 0; y < world->size; ++y) {
+        if (table->rows[y] != NULL || old->rows[y] == NULL) continue;
+        table->rows[y] = old->rows[y];
+        atomic_fetch_add_explicit(&table->rows[y]->references, 1, memory_order_relaxed);
+    }
+
+    atomic_store(&published->table, table);
+    uint64_t epoch = atomic_fetch_add(&published->epoch, 1);
+    while (atomic_load(&published->readers[epoch & 1]) != 0) {}
+    table_release(old);
+}
+
+Renoise_Snapshot* renoise_world_snapshot(Renoise_World* world) {
+    Renoise_Published* published = world->published;
+    uint64_t epoch;
+    for (;;) {
+        epoch = atomic_load(&published->epoch);
+        atomic_fetch_add(&published->readers[epoch & 1], 1);
+        // A publish that started a new epoch in between may not wait for this slot anymore
+        if (atomic_load(&published->epoch) == epoch) break;
+        atomic_fetch_sub(&published->readers[epoch & 1], 1);
+    }
+    Published_Table* table = atomic_load(&published->table);
+    atomic_fetch_add_explicit(&table->references, 1, memory_order_relaxed);
+    atomic_fetch_sub(&published->readers[epoch & 1], 1);
+    return &table->snapshot;
+}
+
+static Published_Points* snapshot_points(const Renoise_Snapshot* snapshot, int64_t chunk_x, int64_t chunk_y) {
+    assert(chunk_x >= 0 && chunk_x < snapshot->size);
+    assert(chunk_y >= 0 && chunk_y < snapshot->size);
+    const Published_Table* table = (const Published_Table*) snapshot;
+    return table->rows[chunk_y] != NULL ? table->rows[chunk_y]->chunks[chunk_x] : NULL;
+}
+
+const double* renoise_snapshot_chunk_points(const Renoise_Snapshot* snapshot, int64_t chunk_x, int64_t chunk_y) {
+    Published_Points* points = snapshot_points(snapshot, chunk_x, chunk_y);
+    return points != NULL ? points->points : NULL;
+}
+
+uint64_t renoise_snapshot_chunk_version(const Renoise_Snapshot* snapshot, int64_t chunk_x, int64_t chunk_y) {
+    Published_Points* points = snapshot_points(snapshot, chunk_x, chunk_y);
+    return points != NULL ? points->version : 0;
+}
+
+void renoise_snapshot_free(Renoise_Snapshot* snapshot) {
+    table_release((Published_Table*) snapshot);
+}
@@ -0,0 +1,122 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Every thread gets its own block of counters, so counting never contends with other threads. The blocks are linked
+// together so a snapshot can sum them. They're never freed: the counts of a thread that exited still count.
+typedef struct Stats_Block Stats_Block;
+struct Stats_Block {
+    atomic_uint_fast64_t counters[RENOISE_COUNTER_COUNT];
+    atomic_uint_fast64_t calls[RENOISE_STATS_FUNCTION_COUNT];
+    atomic_uint_fast64_t time_ns[RENOISE_STATS_FUNCTION_COUNT];
+    Stats_Block* next;
+};
+
+atomic_bool renoise_stats_enabled = false;
+static _Atomic(Stats_Block*) stats_blocks = NULL;
+static _Thread_local Stats_Block* thread_stats_block = NULL;
+
+static Stats_Block* stats_block() {
+    if (thread_stats_block != NULL) return thread_stats_block;
+
+    Stats_Block* block = malloc(sizeof(Stats_Block));
+    assert(block != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(block, 0, sizeof(Stats_Block));
+    block->next = atomic_load(&stats_blocks);
+    while (!atomic_compare_exchange_weak(&stats_blocks, &block->next, block));
+    thread_stats_block = block;
+    return block;
+}
+
+uint64_t renoise_now_ns() {
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t) ((double) counter.QuadPart * 1e9 / frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+void renoise_stats_enable(bool enable) {
+    atomic_store(&renoise_stats_enabled, enable);
+}
+
+void renoise_stats_count(Renoise_Counter counter, uint64_t amount) {
+    atomic_fetch_add_explicit(&stats_block()->counters[counter], amount, memory_order_relaxed);
+}
+
+uint64_t renoise_stats_begin() {
+    if (!renoise_stats_on()) return 0;
+    uint64_t now = renoise_now_ns();
+    return now == 0 ? 1 : now;
+}
+
+void renoise_stats_end(Renoise_Stats_Function function, uint64_t start) {
+    if (start == 0) return;
+    Stats_Block* block = stats_block();
+    atomic_fetch_add_explicit(&block->calls[function], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&block->time_ns[function], renoise_now_ns() - start, memory_order_relaxed);
+}
+
+Renoise_Stats renoise_stats_snapshot() {
+    // Every counter is read atomically, but other threads may keep counting while the blocks are being summed
+    Renoise_Stats stats = {0};
+    for (Stats_Block* block = atomic_load(&stats_blocks); block != NULL; block = block->next) {
+        stats.chunks_generated += atomic_load_explicit(&block->counters[RENOISE_COUNTER_CHUNKS_GENERATED], memory_order_relaxed);
+        stats.samples_evaluated += atomic_load_explicit(&block->counters[RENOISE_COUNTER_SAMPLES_EVALUATED], memory_order_relaxed);
+        stats.grad_points_rolled += atomic_load_explicit(&block->counters[RENOISE_COUNTER_GRAD_POINTS_ROLLED], memory_order_relaxed);
+        stats.neighbour_hops += atomic_load_explicit(&block->counters[RENOISE_COUNTER_NEIGHBOUR_HOPS], memory_order_relaxed);
+        for (int function = 0; function < RENOISE_STATS_FUNCTION_COUNT; ++function) {
+            stats.calls[function] += atomic_load_explicit(&block->calls[function], memory_order_relaxed);
+            stats.time_ns[function] += atomic_load_explicit(&block->time_ns[function], memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+const char* renoise_stats_function_name(Renoise_Stats_Function function) {
+    switch (function) {
+    case RENOISE_STATS_CHUNK_GENERATE:                        return "renoise_chunk_generate";
+    case RENOISE_STATS_WORLD_GENERATE:                        return "renoise_world_generate";
+    case RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS:           return "renoise_world_generate_chunk_points";
+    case RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_QUANTIZED: return "renoise_world_generate_chunk_points_quantized";
+    case RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_FIXED:     return "renoise_world_generate_chunk_points_fixed";
+    case RENOISE_STATS_WORLD_GENERATE_CHUNK_POINTS_DERIVATIVES: return "renoise_world_generate_chunk_points_derivatives";
+    case RENOISE_STATS_WORLD_REGENERATE_RECT:                 return "renoise_world_regenerate_rect";
+    case RENOISE_STATS_WORLD_REGENERATE_FULL_CHUNK:           return "renoise_world_regenerate_full_chunk";
+    case RENOISE_STATS_WORLD_UNDO:                            return "renoise_world_undo";
+    case RENOISE_STATS_WORLD_REDO:                            return "renoise_world_redo";
+    case RENOISE_STATS_WORLD_GET_CHUNK:                       return "renoise_world_get_chunk";
+    case RENOISE_STATS_WORLD_TICK:                            return "renoise_world_tick";
+    case RENOISE_STATS_REGENERATION_STEP:                     return "renoise_regeneration_step";
+    case RENOISE_STATS_VISIBILITY_UPDATE:                     return "renoise_visibility_update";
+    case RENOISE_STATS_FUNCTION_COUNT:                        break;
+    }
+    assert(false && "ERROR: Unknown stats function");
+    return "unknown";
+}
@@ -0,0 +1,261 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <string.h>
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Chunks are either resident, with their gradient points and points in memory, or evicted, keeping only the RNG
+// streams of their gradient points. The points are a pure function of the gradient points of the chunk and its
+// neighbours, and the gradient points of the seed and the streams, so an evicted chunk gets its gradient points
+// regenerated and its points recomputed when it gets accessed again. Chunks get evicted when they sit idle (see
+// renoise_world_tick) and when the world goes over its memory budget.
+
+static void chunk_regenerate_grad_points(Renoise_Chunk* chunk) {
+    assert(chunk->grad_points == NULL);
+
+    int64_t grad_point_count = chunk->grad_point_count_x * chunk->grad_point_count_y;
+    chunk->grad_points = malloc(grad_point_count * sizeof(*chunk->grad_points));
+    assert(chunk->grad_points != NULL && "ERROR: Out of memory; buy more RAM.");
+    for (int64_t i = 0; i < grad_point_count; ++i) {
+        chunk->grad_points[i] = renoise_chunk_gradient_point(chunk, i, chunk->grad_streams[i]);
+    }
+}
+
+void renoise_world_restore_grad_points(Renoise_World* world, Renoise_Chunk* chunk) {
+    int64_t size_before = renoise_chunk_payload_size(chunk);
+    chunk_regenerate_grad_points(chunk);
+    world->resident_size += renoise_chunk_payload_size(chunk) - size_before;
+    renoise_world_touch_chunk(world, chunk);
+}
+
+bool renoise_chunk_is_evicted(Renoise_Chunk* chunk) {
+    return chunk->points == NULL && chunk->grad_points == NULL;
+}
+
+// Huge pages are 2 MiB on x86-64 and most ARM64 systems
+#define PLANE_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+double* renoise_plane_alloc(int64_t size) {
+    size_t bytes = size * sizeof(double);
+    // Planes smaller than a huge page just get cache line alignment. Bigger ones are rounded up to whole huge pages,
+    // so the OS can back all of the plane with them.
+    size_t alignment = 64;
+    if (bytes >= PLANE_HUGE_PAGE_SIZE) {
+        alignment = PLANE_HUGE_PAGE_SIZE;
+        bytes = (bytes + PLANE_HUGE_PAGE_SIZE - 1) / PLANE_HUGE_PAGE_SIZE * PLANE_HUGE_PAGE_SIZE;
+    }
+#ifdef _WIN32
+    // Large pages need a privilege most processes don't have, so Windows gets normal pages
+    double* plane = _aligned_malloc(bytes, alignment);
+    assert(plane != NULL && "ERROR: Out of memory; buy more RAM.");
+#else
+    double* plane = NULL;
+    int error = posix_memalign((void**) &plane, alignment, bytes);
+    assert(error == 0 && "ERROR: Out of memory; buy more RAM.");
+    (void) error;
+#ifdef MADV_HUGEPAGE
+    if (alignment == PLANE_HUGE_PAGE_SIZE) madvise(plane, bytes, MADV_HUGEPAGE);
+#endif
+#endif
+    memset(plane, 0, size * sizeof(double));
+    return plane;
+}
+
+void renoise_plane_free(double* plane) {
+#ifdef _WIN32
+    _aligned_free(plane);
+#else
+    free(plane);
+#endif
+}
+
+int64_t renoise_chunk_payload_size(Renoise_Chunk* chunk) {
+    int64_t size = 0;
+    if (chunk->grad_points != NULL) size += chunk->grad_point_count_x * chunk->grad_point_count_y * sizeof(*chunk->grad_points);
+    if (chunk->points != NULL) size += chunk->size*chunk->size * sizeof(*chunk->points);
+    return size;
+}
+
+int64_t renoise_chunk_memory_usage(Renoise_Chunk* chunk) {
+    int64_t grad_point_count = chunk->grad_point_count_x * chunk->grad_point_count_y;
+    return sizeof(*chunk) + grad_point_count * sizeof(*chunk->grad_streams) + renoise_chunk_payload_size(chunk);
+}
+
+int64_t renoise_world_memory_usage(Renoise_World* world) {
+    int64_t usage = sizeof(*world) + world->size*world->size * sizeof(*world->chunks);
+    for (int64_t i = 0; i < world->size*world->size; ++i) {
+        usage += renoise_chunk_memory_usage(world->chunks[i]);
+    }
+    return usage;
+}
+
+static void world_lru_unlink(Renoise_World* world, Renoise_Chunk* chunk) {
+    if (chunk->lru_prev != NULL) chunk->lru_prev->lru_next = chunk->lru_next;
+    else if (world->lru_head == chunk) world->lru_head = chunk->lru_next;
+    else return; // Not linked
+    if (chunk->lru_next != NULL) chunk->lru_next->lru_prev = chunk->lru_prev;
+    else world->lru_tail = chunk->lru_prev;
+    chunk->lru_prev = NULL;
+    chunk->lru_next = NULL;
+}
+
+void renoise_world_touch_chunk(Renoise_World* world, Renoise_Chunk* chunk) {
+    chunk->last_access = world->tick;
+    if (world->lru_head == chunk) return;
+
+    world_lru_unlink(world, chunk);
+    chunk->lru_next = world->lru_head;
+    if (world->lru_head != NULL) world->lru_head->lru_prev = chunk;
+    world->lru_head = chunk;
+    if (world->lru_tail == NULL) world->lru_tail = chunk;
+}
+
+static void world_evict_chunk(Renoise_World* world, Renoise_Chunk* chunk) {
+    assert(world->plane == NULL && "ERROR: The chunks of a world with a plane can't be evicted");
+    world->resident_size -= renoise_chunk_payload_size(chunk);
+    free(chunk->grad_points);
+    chunk->grad_points = NULL;
+    free(chunk->points);
+    chunk->points = NULL;
+    world_lru_unlink(world, chunk);
+    world->cache.evictions += 1;
+}
+
+void renoise_world_enforce_memory_budget(Renoise_World* world) {
+    if (world->memory_budget == 0) return;
+    // The most recently used chunk is never evicted, the caller is probably still using it
+    while (world->resident_size > world->memory_budget && world->lru_tail != world->lru_head) {
+        world_evict_chunk(world, world->lru_tail);
+    }
+}
+
+void renoise_world_set_memory_budget(Renoise_World* world, int64_t memory_budget) {
+    assert(memory_budget >= 0);
+    assert((world->plane == NULL || memory_budget == 0) && "ERROR: The chunks of a world with a plane can't be evicted");
+    world->memory_budget = memory_budget;
+    renoise_world_enforce_memory_budget(world);
+}
+
+// Moves an allocation to a fresh one, so allocations that get moved one after another end up close together.
+// The old allocation is handed to `old` instead of freed, so the allocator can't reuse it for the next move.
+static void* chunk_move_allocation(void* data, size_t size, void*** old) {
+    if (data == NULL) return NULL;
+    void* moved = malloc(size);
+    assert(moved != NULL && "ERROR: Out of memory; buy more RAM.");
+    memcpy(moved, data, size);
+    *(*old)++ = data;
+    return moved;
+}
+
+void renoise_world_set_chunk_order(Renoise_World* world, Renoise_Chunk_Order order) {
+    int64_t chunk_count = world->size*world->size;
+    Renoise_Chunk** chunks = malloc(chunk_count * sizeof(*chunks));
+    uint64_t* dirty_chunks = calloc((chunk_count + 63) / 64, sizeof(*dirty_chunks));
+    // Every chunk has at most three allocations to move
+    void** old = malloc(chunk_count * 3 * sizeof(*old));
+    assert(chunks != NULL && dirty_chunks != NULL && old != NULL && "ERROR: Out of memory; buy more RAM.");
+
+    Renoise_World reordered = *world;
+    reordered.chunk_order = order;
+    for (int64_t i = 0; i < chunk_count; ++i) {
+        Renoise_Chunk* chunk = world->chunks[i];
+        int64_t index = renoise_world_chunk_index(&reordered, chunk->x, chunk->y);
+        chunks[index] = chunk;
+        if (world->dirty_chunks[i / 64] & ((uint64_t) 1 << (i % 64))) {
+            dirty_chunks[index / 64] |= (uint64_t) 1 << (index % 64);
+        }
+    }
+
+    void** old_end = old;
+    for (int64_t i = 0; i < chunk_count; ++i) {
+        Renoise_Chunk* chunk = chunks[i];
+        int64_t grad_point_count = chunk->grad_point_count_x * chunk->grad_point_count_y;
+        chunk->grad_points = chunk_move_allocation(chunk->grad_points, grad_point_count * sizeof(*chunk->grad_points), &old_end);
+        chunk->grad_streams = chunk_move_allocation(chunk->grad_streams, grad_point_count * sizeof(*chunk->grad_streams), &old_end);
+        // The points of a plane world stay where they are
+        if (world->plane == NULL) {
+            chunk->points = chunk_move_allocation(chunk->points, chunk->size*chunk->size * sizeof(*chunk->points), &old_end);
+        }
+    }
+    for (void** it = old; it < old_end; ++it) free(*it);
+    free(old);
+
+    free(world->chunks);
+    world->chunks = chunks;
+    free(world->dirty_chunks);
+    world->dirty_chunks = dirty_chunks;
+    world->chunk_order = order;
+}
+
+Renoise_Chunk* renoise_world_load_chunk(Renoise_World* world, Renoise_Chunk* chunk) {
+    if (chunk->points != NULL) {
+        renoise_world_touch_chunk(world, chunk);
+        return chunk;
+    }
+
+    if (chunk->x < 1 || chunk->x >= world->size - 1 || chunk->y < 1 || chunk->y >= world->size - 1) {
+        // Chunks on the edge of the world never get their points generated
+        if (chunk->grad_points == NULL) renoise_world_restore_grad_points(world, chunk);
+        chunk->points = calloc(chunk->size*chunk->size, sizeof(*chunk->points));
+        assert(chunk->points != NULL && "ERROR: Out of memory; buy more RAM.");
+        chunk->points_stride = chunk->size;
+        world->resident_size += chunk->size*chunk->size * sizeof(*chunk->points);
+    } else {
+        renoise_world_fill_chunk_points(world, chunk);
+        // A dormant chunk of a world generated with renoise_world_generate_region gets its first points
+        if (chunk->version == 0) renoise_world_mark_chunk_changed(world, chunk);
+    }
+    renoise_world_touch_chunk(world, chunk);
+    renoise_world_enforce_memory_budget(world);
+    return chunk;
+}
+
+Renoise_Chunk* renoise_world_get_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    assert(chunk_x >= 0 && chunk_x < world->size);
+    assert(chunk_y >= 0 && chunk_y < world->size);
+    uint64_t stats_start = renoise_stats_begin();
+    Renoise_Chunk* chunk = world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)];
+    if (chunk->points != NULL) world->cache.hits += 1;
+    else world->cache.misses += 1;
+    renoise_world_load_chunk(world, chunk);
+    renoise_stats_end(RENOISE_STATS_WORLD_GET_CHUNK, stats_start);
+    return chunk;
+}
+
+void renoise_world_evict_chunk(Renoise_World* world, int64_t chunk_x, int64_t chunk_y) {
+    assert(chunk_x >= 0 && chunk_x < world->size);
+    assert(chunk_y >= 0 && chunk_y < world->size);
+    world_evict_chunk(world, world->chunks[renoise_world_chunk_index(world, chunk_x, chunk_y)]);
+}
+
+void renoise_world_tick(Renoise_World* world) {
+    world->tick += 1;
+    if (world->cold_after == 0) return;
+    uint64_t stats_start = renoise_stats_begin();
+
+    // The LRU list is ordered by last access, so the idle chunks are all at its tail. Also catches chunks that only
+    // had their gradient points restored for a neighbour, those are in the list too.
+    while (world->lru_tail != NULL && world->tick - world->lru_tail->last_access >= world->cold_after) {
+        world_evict_chunk(world, world->lru_tail);
+    }
+    renoise_stats_end(RENOISE_STATS_WORLD_TICK, stats_start);
+}
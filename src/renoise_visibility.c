@@ -0,0 +1,192 @@
+// renoise: a library for generating and regenerating terrain noise
+// Copyright (C) 2025  gstaaij
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "renoise.h"
+#include "renoise_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static void chunk_list_push(Renoise_Chunk_List* list, int64_t index) {
+    if (list->count >= list->capacity) {
+        list->capacity = list->capacity == 0 ? 64 : list->capacity * 2;
+        list->items = realloc(list->items, list->capacity * sizeof(*list->items));
+        assert(list->items != NULL && "ERROR: Out of memory; buy more RAM.");
+    }
+    list->items[list->count++] = index;
+}
+
+static bool bits_get(const uint64_t* bits, int64_t index) {
+    return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+Renoise_Visibility* renoise_visibility_create(Renoise_World* world) {
+    Renoise_Visibility* visibility = malloc(sizeof(Renoise_Visibility));
+    assert(visibility != NULL && "ERROR: Out of memory; buy more RAM.");
+    memset(visibility, 0, sizeof(Renoise_Visibility));
+    visibility->world = world;
+    int64_t word_count = (world->size*world->size + 63) / 64;
+    visibility->visible_bits = calloc(word_count, sizeof(*visibility->visible_bits));
+    visibility->previous_bits = calloc(word_count, sizeof(*visibility->previous_bits));
+    assert(visibility->visible_bits != NULL && visibility->previous_bits != NULL && "ERROR: Out of memory; buy more RAM.");
+    return visibility;
+}
+
+// Separating axis test of a convex polygon against the box [min, max]; touching doesn't count as overlapping
+static bool polygon_overlaps_box(const Renoise_Vector* points, int count, Renoise_Vector min, Renoise_Vector max) {
+    for (int i = 0; i < count; ++i) {
+        Renoise_Vector a = points[i];
+        Renoise_Vector b = points[(i + 1) % count];
+        double normal_x = a.y - b.y;
+        double normal_y = b.x - a.x;
+        if (normal_x == 0.0 && normal_y == 0.0) continue;
+
+        double polygon_min = INFINITY;
+        double polygon_max = -INFINITY;
+        for (int j = 0; j < count; ++j) {
+            double projection = points[j].x * normal_x + points[j].y * normal_y;
+            if (projection < polygon_min) polygon_min = projection;
+            if (projection > polygon_max) polygon_max = projection;
+        }
+        // The box corner furthest along the normal and the one furthest against it
+        double box_max = (normal_x > 0.0 ? max.x : min.x) * normal_x + (normal_y > 0.0 ? max.y : min.y) * normal_y;
+        double box_min = (normal_x > 0.0 ? min.x : max.x) * normal_x + (normal_y > 0.0 ? min.y : max.y) * normal_y;
+        if (polygon_max <= box_min || polygon_min >= box_max) return false;
+    }
+    return true;
+}
+
+static void visibility_add_view(Renoise_Visibility* visibility, Renoise_View view) {
+    Renoise_World* world = visibility->world;
+    int point_count = 2;
+    switch (view.kind) {
+    case RENOISE_VIEW_AABB:     point_count = 2; break;
+    case RENOISE_VIEW_TRIANGLE: point_count = 3; break;
+    case RENOISE_VIEW_FRUSTUM:  point_count = 4; break;
+    }
+    Renoise_Vector min = {  INFINITY,  INFINITY };
+    Renoise_Vector max = { -INFINITY, -INFINITY };
+    for (int i = 0; i < point_count; ++i) {
+        if (view.points[i].x < min.x) min.x = view.points[i].x;
+        if (view.points[i].y < min.y) min.y = view.points[i].y;
+        if (view.points[i].x > max.x) max.x = view.points[i].x;
+        if (view.points[i].y > max.y) max.y = view.points[i].y;
+    }
+    if (!(min.x < max.x && min.y < max.y)) return;
+
+    // The chunks the bounding box overlaps, which is all the chunks the view can overlap
+    double size = world->chunk_size;
+    int64_t start_x = min.x / size < 0.0 ? 0 : (int64_t) floor(min.x / size);
+    int64_t start_y = min.y / size < 0.0 ? 0 : (int64_t) floor(min.y / size);
+    int64_t end_x = max.x / size > world->size ? world->size : (int64_t) ceil(max.x / size);
+    int64_t end_y = max.y / size > world->size ? world->size : (int64_t) ceil(max.y / size);
+    for (int64_t chunk_y = start_y; chunk_y < end_y; ++chunk_y) {
+        for (int64_t chunk_x = start_x; chunk_x < end_x; ++chunk_x) {
+            int64_t index = chunk_x + chunk_y * world->size;
+            if (bits_get(visibility->visible_bits, index)) continue;
+            if (view.kind != RENOISE_VIEW_AABB) {
+                Renoise_Vector chunk_min = { chunk_x * size, chunk_y * size };
+                Renoise_Vector chunk_max = { (chunk_x + 1) * size, (chunk_y + 1) * size };
+                if (!polygon_overlaps_box(view.points, point_count, chunk_min, chunk_max)) continue;
+            }
+            visibility->visible_bits[index / 64] |= (uint64_t) 1 << (index % 64);
+            chunk_list_push(&visibility->visible, index);
+        }
+    }
+}
+
+// Whether applying `operation` would change the points of a chunk that's visible
+static bool visibility_operation_shows(Renoise_Visibility* visibility, Renoise_Operation operation) {
+    Renoise_World* world = visibility->world;
+    int64_t start_x, start_y, end_x, end_y;
+    renoise_world_operation_chunks(world, operation, &start_x, &start_y, &end_x, &end_y);
+    for (int64_t chunk_y = start_y; chunk_y < end_y; ++chunk_y) {
+        for (int64_t chunk_x = start_x; chunk_x < end_x; ++chunk_x) {
+            if (bits_get(visibility->visible_bits, chunk_x + chunk_y * world->size)) return true;
+        }
+    }
+    return false;
+}
+
+// Regenerates a chunk that stopped being visible without changing what's still seen. A full chunk regeneration also
+// changes the points of the chunks around it, so next to a visible chunk only the gradient points inside the chunk get
+// rolled. When the warp reaches a visible chunk even from there, the chunk is left as it is.
+static void visibility_regenerate_hidden(Renoise_Visibility* visibility, int64_t chunk_x, int64_t chunk_y) {
+    Renoise_World* world = visibility->world;
+    Renoise_Operation operation = {
+        .kind = RENOISE_OPERATION_REGENERATE_FULL_CHUNK,
+        .chunk_x = chunk_x,
+        .chunk_y = chunk_y,
+        .width = 1,
+        .height = 1,
+        .stream = world->rng_stream + 1,
+    };
+    if (visibility_operation_shows(visibility, operation)) operation.kind = RENOISE_OPERATION_REGENERATE_RECT;
+    if (visibility_operation_shows(visibility, operation)) return;
+    renoise_world_apply_operation(world, operation);
+}
+
+void renoise_visibility_update(Renoise_Visibility* visibility, const Renoise_View* views, int64_t view_count) {
+    uint64_t stats_start = renoise_stats_begin();
+    // Last update's visible set becomes the previous one; the previous bits were cleared at the end of the last update
+    Renoise_Chunk_List list = visibility->previous;
+    visibility->previous = visibility->visible;
+    visibility->visible = list;
+    visibility->visible.count = 0;
+    uint64_t* bits = visibility->previous_bits;
+    visibility->previous_bits = visibility->visible_bits;
+    visibility->visible_bits = bits;
+
+    for (int64_t i = 0; i < view_count; ++i) visibility_add_view(visibility, views[i]);
+
+    visibility->shown.count = 0;
+    for (int64_t i = 0; i < visibility->visible.count; ++i) {
+        int64_t index = visibility->visible.items[i];
+        if (!bits_get(visibility->previous_bits, index)) chunk_list_push(&visibility->shown, index);
+    }
+    visibility->hidden.count = 0;
+    for (int64_t i = 0; i < visibility->previous.count; ++i) {
+        int64_t index = visibility->previous.items[i];
+        if (!bits_get(visibility->visible_bits, index)) chunk_list_push(&visibility->hidden, index);
+        visibility->previous_bits[index / 64] &= ~((uint64_t) 1 << (index % 64));
+    }
+
+    if (visibility->regenerate_hidden) {
+        Renoise_World* world = visibility->world;
+        for (int64_t i = 0; i < visibility->hidden.count; ++i) {
+            int64_t index = visibility->hidden.items[i];
+            visibility_regenerate_hidden(visibility, index % world->size, index / world->size);
+        }
+    }
+    renoise_stats_end(RENOISE_STATS_VISIBILITY_UPDATE, stats_start);
+}
+
+bool renoise_visibility_is_visible(const Renoise_Visibility* visibility, int64_t chunk_x, int64_t chunk_y) {
+    assert(chunk_x >= 0 && chunk_x < visibility->world->size);
+    assert(chunk_y >= 0 && chunk_y < visibility->world->size);
+    return bits_get(visibility->visible_bits, chunk_x + chunk_y * visibility->world->size);
+}
+
+void renoise_visibility_free(Renoise_Visibility* visibility) {
+    free(visibility->visible.items);
+    free(visibility->shown.items);
+    free(visibility->hidden.items);
+    free(visibility->previous.items);
+    free(visibility->visible_bits);
+    free(visibility->previous_bits);
+    free(visibility);
+}